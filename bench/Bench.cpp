@@ -0,0 +1,100 @@
+#include "Bench.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#else
+#include <time.h>
+#endif
+
+static uintptr_t paintedBottom;  // An address only; the frame is gone by the time it is scanned
+
+uint64_t Bench::nowNs() {
+#ifdef ESP_PLATFORM
+    return (uint64_t)esp_timer_get_time() * 1000;
+#else
+    // Real time; millis() on the host is simulated and only moves on delay()
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+// Fills the stack below the caller's frame. The next call from the same
+// frame lands on the same bytes, so whatever it leaves unpainted it used.
+__attribute__((noinline)) static void paintStack() {
+    volatile uint8_t region[BENCH_STACK_PAINT];
+    for (size_t i = 0; i < sizeof(region); i++) {
+        region[i] = BENCH_STACK_FILL;
+    }
+    paintedBottom = (uintptr_t)region;
+}
+
+__attribute__((noinline)) size_t Bench::measureStack(const BenchCase& benchCase) {
+    paintStack();
+    benchCase.run(benchCase.context);
+    // The stack grows down on both Xtensa and x86-64; scan up from the far end
+    volatile uint8_t* painted = (volatile uint8_t*)paintedBottom;
+    size_t untouched = 0;
+    while (untouched < BENCH_STACK_PAINT && painted[untouched] == BENCH_STACK_FILL) {
+        untouched++;
+    }
+    return BENCH_STACK_PAINT - untouched;
+}
+
+void Bench::timedRun(const BenchCase& benchCase, uint32_t iterations, uint64_t& elapsedNs) {
+    uint64_t start = nowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchCase.run(benchCase.context);
+    }
+    elapsedNs = nowNs() - start;
+}
+
+void Bench::printHeader(Print& out, const char* platform) {
+    out.printf("# bench platform=%s cpuMHz=%lu minTimeUs=%lu stackPaint=%u\n", platform,
+               (unsigned long)getCpuFrequencyMhz(), (unsigned long)BENCH_MIN_TIME_US, (unsigned)BENCH_STACK_PAINT);
+    out.println("name,iterations,ns_per_op,allocs_per_op,bytes_per_op,peak_stack_bytes");
+}
+
+BenchResult Bench::run(const BenchCase& benchCase) {
+    BenchResult result = {};
+    uint32_t limit = benchCase.maxIterations ? benchCase.maxIterations : BENCH_MAX_ITERATIONS;
+
+    Serial.flush();
+    Serial.end();
+    benchCase.run(benchCase.context);  // Warm-up: first-call caches and lazily loaded state
+    result.peakStack = measureStack(benchCase);
+
+    uint32_t iterations = 1;
+    uint64_t elapsedNs;
+    for (;;) {
+        BenchAlloc::start();
+        timedRun(benchCase, iterations, elapsedNs);
+        BenchAlloc::stop();
+        if (elapsedNs >= BENCH_MIN_TIME_US * 1000ULL || iterations >= limit) break;
+        iterations = iterations * 2 < limit ? iterations * 2 : limit;
+        delay(1);  // Lets the idle task feed the watchdog between rounds
+    }
+    Serial.begin(115200);
+
+    result.iterations = iterations;
+    result.nsPerOp = (double)elapsedNs / iterations;
+    result.allocsPerOp = (double)BenchAlloc::getAllocations() / iterations;
+    result.bytesPerOp = (double)BenchAlloc::getBytes() / iterations;
+    return result;
+}
+
+void Bench::printResult(Print& out, const char* name, const BenchResult& result) {
+    out.printf("%s,%lu,%.1f,%.2f,%.1f,%u\n", name, (unsigned long)result.iterations, result.nsPerOp,
+               result.allocsPerOp, result.bytesPerOp, (unsigned)result.peakStack);
+}
+
+size_t Bench::runAll(Print& out, const BenchCase* cases, size_t count, const char* filter) {
+    size_t ran = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (filter && *filter && strncmp(cases[i].name, filter, strlen(filter)) != 0) continue;
+        BenchResult result = run(cases[i]);
+        printResult(out, cases[i].name, result);
+        ran++;
+    }
+    return ran;
+}
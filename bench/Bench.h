@@ -0,0 +1,62 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+
+#define BENCH_MIN_TIME_US 200000  // Each case repeats until it has run this long
+#define BENCH_MAX_ITERATIONS 1000000
+#define BENCH_STACK_PAINT 12288   // Deepest stack use that can be measured, bytes
+#define BENCH_STACK_FILL 0xA5
+
+typedef void (*BenchFunction)(void* context);
+
+struct BenchCase {
+    const char* name;
+    BenchFunction run;
+    void* context;
+    uint32_t maxIterations;  // 0 for BENCH_MAX_ITERATIONS; caps cases that write flash
+};
+
+struct BenchResult {
+    uint32_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+    size_t peakStack;  // BENCH_STACK_PAINT means the paint ran out
+};
+
+// Heap calls made by the benchmark task while counting is on. On the board
+// the linker wraps malloc/calloc/realloc/free; on the host they are
+// interposed over glibc's, so operator new and String are counted too.
+class BenchAlloc {
+public:
+    static void start();
+    static void stop();
+    static uint32_t getAllocations();
+    static uint32_t getBytes();
+};
+
+// Runs each case once to warm up, once over a painted stack to find its
+// deepest stack use, then in a timed loop that doubles its iteration count
+// until it lasts BENCH_MIN_TIME_US. Serial is closed while a case runs, so
+// log lines inside it cost their formatting but never wait on the UART.
+//
+// Output is "# " header lines and one CSV row per case:
+//   name,iterations,ns_per_op,allocs_per_op,bytes_per_op,peak_stack_bytes
+class Bench {
+private:
+    static uint64_t nowNs();
+    static size_t measureStack(const BenchCase& benchCase);
+    static void timedRun(const BenchCase& benchCase, uint32_t iterations, uint64_t& elapsedNs);
+
+public:
+    static void printHeader(Print& out, const char* platform);
+    static BenchResult run(const BenchCase& benchCase);
+    static void printResult(Print& out, const char* name, const BenchResult& result);
+
+    // Runs every case whose name starts with filter (all when null or empty)
+    // and returns how many ran
+    static size_t runAll(Print& out, const BenchCase* cases, size_t count, const char* filter);
+};
+
+#endif // BENCH_H
@@ -0,0 +1,119 @@
+#include "Bench.h"
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+static volatile bool counting = false;
+static uint32_t allocations = 0;
+static uint32_t bytes = 0;
+
+#ifdef ESP_PLATFORM
+
+// env:bench links with --wrap for each of these, so every caller in the
+// image, including libstdc++'s operator new and String, comes through here.
+// Only the benchmark task is counted; WiFi and lwIP are not started, but
+// esp_timer and IPC tasks still allocate now and then.
+static TaskHandle_t countingTask = nullptr;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+}
+
+static inline void record(size_t size) {
+    if (counting && xTaskGetCurrentTaskHandle() == countingTask) {
+        allocations++;
+        bytes += size;
+    }
+}
+
+extern "C" void* __wrap_malloc(size_t size) {
+    record(size);
+    return __real_malloc(size);
+}
+
+extern "C" void* __wrap_calloc(size_t count, size_t size) {
+    record(count * size);
+    return __real_calloc(count, size);
+}
+
+extern "C" void* __wrap_realloc(void* ptr, size_t size) {
+    record(size);
+    return __real_realloc(ptr, size);
+}
+
+extern "C" void __wrap_free(void* ptr) {
+    __real_free(ptr);
+}
+
+void BenchAlloc::start() {
+    allocations = 0;
+    bytes = 0;
+    countingTask = xTaskGetCurrentTaskHandle();
+    counting = true;
+}
+
+#else
+
+// Defined in the executable, these replace glibc's for every caller,
+// including libstdc++; the __libc_ entry points are glibc's own allocator
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) noexcept {
+    if (counting) {
+        allocations++;
+        bytes += size;
+    }
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    if (counting) {
+        allocations++;
+        bytes += count * size;
+    }
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+    if (counting) {
+        allocations++;
+        bytes += size;
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) noexcept {
+    __libc_free(ptr);
+}
+}
+#endif  // Other C libraries report zero allocations
+
+void BenchAlloc::start() {
+    allocations = 0;
+    bytes = 0;
+    counting = true;
+}
+
+#endif
+
+void BenchAlloc::stop() {
+    counting = false;
+}
+
+uint32_t BenchAlloc::getAllocations() {
+    return allocations;
+}
+
+uint32_t BenchAlloc::getBytes() {
+    return bytes;
+}
@@ -0,0 +1,299 @@
+// Microbenchmarks for the firmware's hot paths, built as env:bench for the
+// board and env:bench_native for the host. See Bench.h for the method and
+// output format, and tools/benchcompare.py to compare two runs.
+//
+// Host: .pio/build/bench_native/program [name prefix] [data directory]
+// Board: results print on Serial after boot; -DBENCH_FILTER=\"payload.\"
+// limits the run to matching cases.
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "Bench.h"
+#include "ConfigLoader.h"
+#include "NetworkController.h"
+#include "MQTTModule.h"
+#include "CredentialStore.h"
+#include "CommandRouter.h"
+#include "PayloadWriter.h"
+#include "SensorBatch.h"
+#include "TaskMessages.h"
+
+#ifndef BENCH_FILTER
+#define BENCH_FILTER ""
+#endif
+
+#define BENCH_TASK_STACK (BENCH_STACK_PAINT + 8192)
+
+static NetworkController netManager;
+static MQTTModule mqtt(&netManager);
+
+static CredentialStore certStore;
+static SensorBatch fullBatch;
+static CommandRouter commandRouter;
+static CommandQueue commandQueue;
+static volatile uintptr_t sink;  // Keeps results alive past the optimizer
+
+// An inbound command as PubSubClient would hand it to MQTTModule::callback()
+struct CommandSample {
+    char topic[COMMAND_TOPIC_SIZE];
+    uint8_t payload[64];
+    unsigned int length;
+    PayloadFormat format;
+};
+
+static CommandSample jsonCommand;
+static CommandSample msgpackCommand;
+
+static PayloadFormat formatOf(void* context) {
+    return (PayloadFormat)(uintptr_t)context;
+}
+
+// Same copy into the queue as onCommand() in main.cpp
+static void onCommand(const char* topic, const uint8_t* payload, unsigned int length) {
+    CommandMessage* cmd = commandQueue.prepare();
+    if (!cmd) return;
+    strlcpy(cmd->topic, topic, sizeof(cmd->topic));
+    cmd->length = length < sizeof(cmd->payload) ? length : sizeof(cmd->payload) - 1;
+    memcpy(cmd->payload, payload, cmd->length);
+    cmd->payload[cmd->length] = '\0';
+    cmd->receivedAt = millis();
+    commandQueue.commit();
+}
+
+static void onStatusCommand(JsonObjectConst command) {
+    sink = sink + 1;
+}
+
+static void prepareCommand(CommandSample& sample, PayloadFormat format) {
+    strlcpy(sample.topic, ConfigLoader::getMQTTCommandTopic(), sizeof(sample.topic));
+    PayloadWriter writer((char*)sample.payload, sizeof(sample.payload), format);
+    writer.beginObject();
+    writer.add("action", "status");
+    writer.endObject();
+    sample.length = writer.size();
+    sample.format = format;
+}
+
+static void setupFixtures() {
+    if (!ConfigLoader::loadConfig()) {  // Also leaves a snapshot for config.load.snapshot
+        Serial.println("Failed to load config, using defaults");
+    }
+
+    mqtt.setTopics(
+        ConfigLoader::getMQTTStatusTopic(),
+        ConfigLoader::getMQTTCommandTopic(),
+        ConfigLoader::getMQTTSensorTopic(),
+        ConfigLoader::getMQTTHeartbeatTopic()
+    );
+    mqtt.setCommandCallback(onCommand);
+    mqtt.subscribe(ConfigLoader::getMQTTCommandTopic(), onCommand);
+    commandRouter.on("status", onStatusCommand);
+    prepareCommand(jsonCommand, PAYLOAD_JSON);
+    prepareCommand(msgpackCommand, PAYLOAD_MSGPACK);
+
+    fullBatch.configure(SensorBatch::MAX_SAMPLES, 0);
+    for (size_t i = 0; i < SensorBatch::MAX_SAMPLES; i++) {
+        fullBatch.add(10000 * i, 21.0f + 0.1f * (i % 5), 48.0f - 0.2f * (i % 3));
+    }
+}
+
+static void benchConfigLoadSnapshot(void* context) {
+    ConfigLoader::loadConfig();
+}
+
+static void benchConfigLoadJson(void* context) {
+    // Includes the remove; without it the snapshot would be used
+    LittleFS.remove("/config.bin");
+    ConfigLoader::loadConfig();
+}
+
+// The getters setup() and the network task call
+static void benchConfigGetters(void* context) {
+    uintptr_t total = 0;
+    total += (uintptr_t)ConfigLoader::getMQTTBroker();
+    total += ConfigLoader::getMQTTPort();
+    total += (uintptr_t)ConfigLoader::getMQTTClientId();
+    total += (uintptr_t)ConfigLoader::getMQTTStatusTopic();
+    total += (uintptr_t)ConfigLoader::getMQTTCommandTopic();
+    total += (uintptr_t)ConfigLoader::getMQTTSensorTopic();
+    total += (uintptr_t)ConfigLoader::getMQTTHeartbeatTopic();
+    total += ConfigLoader::getMQTTQoS();
+    total += ConfigLoader::getMQTTInflightWindow();
+    total += ConfigLoader::getMQTTAckTimeout();
+    total += ConfigLoader::getMQTTKeepAlive();
+    total += ConfigLoader::getMQTTSensorFormat();
+    total += ConfigLoader::getMQTTOutboxMaxBytes();
+    total += ConfigLoader::getNetworkInterfaceCount();
+    total += ConfigLoader::getNetworkInterface(0);
+    total += ConfigLoader::getNetworkProbeInterval();
+    total += ConfigLoader::getHeartbeatInterval();
+    total += ConfigLoader::getStatusInterval();
+    total += ConfigLoader::getMaxIdle();
+    sink = total;
+}
+
+static void benchSensor(void* context) {
+    char payload[TELEMETRY_PAYLOAD_SIZE];
+    PayloadWriter writer(payload, sizeof(payload), formatOf(context));
+    SensorBatch::encodeReading(writer, 123456, 21.37f, 48.2f);
+    sink = writer.size();
+}
+
+static void benchBatch(void* context) {
+    char payload[TELEMETRY_PAYLOAD_SIZE];
+    PayloadWriter writer(payload, sizeof(payload), formatOf(context));
+    fullBatch.encode(writer);
+    sink = writer.size();
+}
+
+static void benchHeartbeat(void* context) {
+    char payload[64];
+    PayloadWriter writer(payload, sizeof(payload), formatOf(context));
+    MQTTModule::formatHeartbeat(writer, 123456);
+    sink = writer.size();
+}
+
+// Same members and nesting as publishStatus() in main.cpp, with fixed values
+static void benchStatus(void* context) {
+    char payload[896];
+    PayloadWriter status(payload, sizeof(payload), formatOf(context));
+    status.beginObject();
+    status.add("uptime", 86400UL);
+    status.add("network", "connected");
+    status.add("mqtt", "connected");
+    status.add("maxStallMs", 12UL);
+    status.beginObject("sampling");
+    status.add("lastJitterUs", 41UL);
+    status.add("maxJitterUs", 180UL);
+    status.add("droppedSamples", 0UL);
+    status.endObject();
+    status.beginObject("reports");
+    status.add("temperatureSent", 120UL);
+    status.add("temperatureSuppressed", 8520UL);
+    status.add("humiditySent", 96UL);
+    status.add("humiditySuppressed", 8544UL);
+    status.endObject();
+    status.beginObject("commands");
+    status.add("handled", 3UL);
+    status.add("unknown", 0UL);
+    status.add("rejected", 1UL);
+    status.endObject();
+    status.beginObject("outbox");
+    status.add("depth", 0UL);
+    status.add("bytes", 0UL);
+    status.add("dropped", 0UL);
+    status.endObject();
+    status.beginObject("failover");
+    status.add("interface", "WiFi");
+    status.add("count", 2UL);
+    status.add("lastMs", 38UL);
+    status.add("mqttOutageMs", 412UL);
+    status.endObject();
+    status.beginObject("scores");
+    status.add("WiFi", 87U);
+    status.add("Ethernet", 95U);
+    status.endObject();
+    status.beginObject("qos");
+    status.add("inflight", 0U);
+    status.add("acked", 8640UL);
+    status.add("resent", 4UL);
+    status.add("lastAckMs", 35UL);
+    status.add("maxAckMs", 1240UL);
+    status.endObject();
+    status.beginObject("power");
+    status.add("mode", "balanced");
+    status.add("lightSleep", false);
+    status.add("wakeLateMs", 2UL);
+    status.add("commandMs", 4UL);
+    status.add("maxCommandMs", 9UL);
+    status.endObject();
+    status.beginObject("tls");
+    status.add("full", 1UL);
+    status.add("resumed", 2UL);
+    status.add("lastFullMs", 1830UL);
+    status.add("lastResumedMs", 310UL);
+    status.add("avgFullMs", 1830UL);
+    status.add("avgResumedMs", 305UL);
+    status.endObject();
+    status.endObject();
+    sink = status.size();
+}
+
+// Topic match, copy into the command queue, then decode and dispatch as loop() does
+static void benchCommand(void* context) {
+    CommandSample* sample = (CommandSample*)context;
+    mqtt.callback(sample->topic, sample->payload, sample->length);
+    while (CommandMessage* cmd = commandQueue.front()) {
+        commandRouter.dispatch(cmd->payload, cmd->length, sample->format);
+        commandQueue.release();
+    }
+}
+
+// Reads and checks all three files every time, as after a failed connect
+static void benchCertsLoad(void* context) {
+    certStore.load();
+}
+
+// What every connect() pays once the certificates are cached
+static void benchCertsCached(void* context) {
+    mqtt.loadCertsFromSPIFFS();
+}
+
+#define FORMAT(format) ((void*)(uintptr_t)(format))
+
+static const BenchCase cases[] = {
+    { "config.load.snapshot", benchConfigLoadSnapshot, nullptr, 0 },
+    { "config.load.json", benchConfigLoadJson, nullptr, 64 },  // Rewrites the snapshot on flash each time
+    { "config.getters", benchConfigGetters, nullptr, 0 },
+    { "payload.sensor.json", benchSensor, FORMAT(PAYLOAD_JSON), 0 },
+    { "payload.sensor.msgpack", benchSensor, FORMAT(PAYLOAD_MSGPACK), 0 },
+    { "payload.batch.json", benchBatch, FORMAT(PAYLOAD_JSON), 0 },
+    { "payload.batch.msgpack", benchBatch, FORMAT(PAYLOAD_MSGPACK), 0 },
+    { "payload.heartbeat.json", benchHeartbeat, FORMAT(PAYLOAD_JSON), 0 },
+    { "payload.heartbeat.msgpack", benchHeartbeat, FORMAT(PAYLOAD_MSGPACK), 0 },
+    { "payload.status.json", benchStatus, FORMAT(PAYLOAD_JSON), 0 },
+    { "payload.status.msgpack", benchStatus, FORMAT(PAYLOAD_MSGPACK), 0 },
+    { "command.json", benchCommand, &jsonCommand, 0 },
+    { "command.msgpack", benchCommand, &msgpackCommand, 0 },
+    { "certs.load", benchCertsLoad, nullptr, 256 },
+    { "certs.cached", benchCertsCached, nullptr, 0 },
+};
+
+static size_t runBenchmarks(const char* platform, const char* filter) {
+    setupFixtures();
+    Bench::printHeader(Serial, platform);
+    size_t ran = Bench::runAll(Serial, cases, sizeof(cases) / sizeof(cases[0]), filter);
+    Serial.printf("# done cases=%u\n", (unsigned)ran);
+    return ran;
+}
+
+#ifdef ESP_PLATFORM
+
+// Own task, so the stack paint fits whatever the loop task was given
+static void benchTask(void* param) {
+    runBenchmarks("esp32", BENCH_FILTER);
+    vTaskDelete(nullptr);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+    xTaskCreatePinnedToCore(benchTask, "bench", BENCH_TASK_STACK, nullptr, 1, nullptr, 1);
+}
+
+void loop() {
+    vTaskDelay(portMAX_DELAY);
+}
+
+#else
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : BENCH_FILTER;
+    const char* dataDirectory = argc > 2 ? argv[2] : "native/data";
+    if (!LittleFS.mountCopy(dataDirectory)) return 1;
+    size_t ran = runBenchmarks("host", filter);
+    LittleFS.removeCopy();
+    return ran > 0 ? 0 : 1;
+}
+
+#endif
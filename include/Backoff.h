@@ -0,0 +1,39 @@
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#include <stdint.h>
+
+// Reconnect scheduling shared by the network and MQTT layers. After the n-th
+// consecutive failure the next attempt is drawn uniformly from
+// [0, min(maxDelay, baseDelay * 2^(n-1))] ("full jitter"), so a fleet that
+// lost the broker at the same moment does not come back at the same moment.
+// Plain C++ so the fleet simulation in tools/ can build it on the host.
+class Backoff {
+private:
+    uint32_t baseDelay;
+    uint32_t maxDelay;
+    uint32_t failures;
+    uint32_t delay;       // Last drawn delay
+    uint32_t lastAttempt;
+    uint32_t state;       // xorshift32; every instance draws its own sequence
+
+    uint32_t nextRandom();
+
+public:
+    Backoff();
+
+    void configure(uint32_t baseDelay, uint32_t maxDelay, uint32_t seed);
+
+    // Count an attempt that failed (or may still fail) and draw the delay before the next
+    void schedule(uint32_t now);
+    // Connected; the next failure starts from baseDelay again
+    void reset();
+    bool isDue(uint32_t now) const { return now - lastAttempt >= delay; }
+    uint32_t msUntilDue(uint32_t now) const { return isDue(now) ? 0 : delay - (now - lastAttempt); }
+
+    uint32_t getFailures() const { return failures; }
+    uint32_t getDelay() const { return delay; }
+    uint32_t getWindow() const;  // Upper bound the current delay was drawn from
+};
+
+#endif // BACKOFF_H
@@ -0,0 +1,67 @@
+#ifndef COMMAND_ROUTER_H
+#define COMMAND_ROUTER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include "PayloadWriter.h"
+
+typedef void (*CommandHandler)(JsonObjectConst command);
+
+// Bump allocator over a fixed buffer for ArduinoJson. Individual frees are
+// ignored; reset() releases everything before the next message.
+class ArenaAllocator : public ArduinoJson::Allocator {
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t used;
+    size_t last;  // Offset of the most recent block, which can grow in place
+
+    static const size_t ALIGN = 8;
+    static size_t blockSize(void* ptr);
+
+public:
+    ArenaAllocator(uint8_t* buffer, size_t capacity);
+
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    void* reallocate(void* ptr, size_t newSize) override;
+
+    void reset() { used = 0; last = SIZE_MAX; }
+    size_t getUsed() const { return used; }
+};
+
+// Decodes inbound commands in place and dispatches on their "action" field
+// through a fixed handler table. Nothing is allocated on the heap per message.
+class CommandRouter {
+public:
+    static const size_t MAX_ROUTES = 16;
+    static const size_t ARENA_SIZE = 2048;
+
+private:
+    struct Route {
+        const char* action;
+        CommandHandler handler;
+    };
+
+    Route routes[MAX_ROUTES];
+    size_t routeCount;
+    alignas(8) uint8_t arenaBuffer[ARENA_SIZE];
+    ArenaAllocator arena;
+
+    std::atomic<uint32_t> handled;
+    std::atomic<uint32_t> unknown;
+    std::atomic<uint32_t> rejected;
+
+public:
+    CommandRouter();
+
+    bool on(const char* action, CommandHandler handler);
+    bool dispatch(const char* payload, size_t length, PayloadFormat format);
+
+    uint32_t getHandled() const { return handled.load(std::memory_order_relaxed); }
+    uint32_t getUnknown() const { return unknown.load(std::memory_order_relaxed); }
+    uint32_t getRejected() const { return rejected.load(std::memory_order_relaxed); }
+};
+
+#endif // COMMAND_ROUTER_H
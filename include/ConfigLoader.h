@@ -3,21 +3,147 @@
 
 #include <LittleFS.h>
 #include <Arduino.h>
-#include <ArduinoJson.h>
+#include "PayloadWriter.h"
+#include "NetInterface.h"
+#include "PowerManager.h"
+#include "FixedString.h"
+
+#define CONFIG_MAX_SUBSCRIPTIONS 4
+
+struct StaticIPConfig {
+    bool enabled;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns1;
+    uint32_t dns2;
+};
+
+struct ReportConfig {
+    float deadband;
+    uint32_t minInterval;
+    uint32_t maxInterval;
+};
+
+// Reconnect backoff for one layer; see Backoff
+struct ReconnectConfig {
+    uint32_t baseDelay;
+    uint32_t maxDelay;
+};
+
+// Parsed copy of config.json. Plain data only, so it can be cached on flash
+// as a binary blob and reloaded without running the JSON parser. Strings are
+// FixedStrings with the same layout as the char arrays they replaced.
+struct DeviceConfig {
+    struct {
+        SSIDString ssid;
+        PassphraseString password;
+        StaticIPConfig staticIP;
+    } wifi;
+
+    struct {
+        uint8_t mac[6];
+        StaticIPConfig staticIP;
+    } ethernet;
+
+    struct {
+        APNString apn;
+        LTECredentialString user;
+        LTECredentialString pass;
+    } lte;
+
+    struct {
+        uint8_t priority[3];  // NetInterface values, highest priority first
+        uint8_t interfaceCount;
+        uint32_t probeInterval;
+        uint32_t probeTimeout;
+        LinkWeights weights;
+        uint8_t hysteresis;
+        uint32_t holdTime;
+        ReconnectConfig reconnect;
+    } network;
+
+    struct {
+        HostString broker;
+        uint16_t port;
+        CredentialString clientId;
+        CredentialString username;
+        CredentialString password;
+        TopicString statusTopic;
+        TopicString commandTopic;
+        TopicString sensorTopic;
+        TopicString heartbeatTopic;
+        TopicString metricsTopic;
+        TopicString subscriptions[CONFIG_MAX_SUBSCRIPTIONS];  // Extra command filters, may use + and #
+        uint8_t subscriptionCount;
+        uint8_t qos;
+        uint8_t inflightWindow;
+        uint32_t ackTimeout;
+        uint16_t keepAlive;
+        ReconnectConfig reconnect;
+        uint8_t statusFormat;  // PayloadFormat per topic
+        uint8_t commandFormat;
+        uint8_t sensorFormat;
+        uint8_t heartbeatFormat;
+        uint8_t metricsFormat;
+        bool outboxEnabled;
+        uint32_t outboxMaxBytes;
+        uint32_t outboxSegmentSize;
+        uint32_t outboxReplayBatch;
+        uint32_t outboxReplayInterval;
+        uint32_t batchSize;
+        uint32_t batchMaxAge;
+    } mqtt;
+
+    struct {
+        uint32_t samplePeriod;
+        uint32_t heartbeatInterval;
+        uint32_t statusInterval;
+        uint32_t metricsInterval;
+        uint32_t maxIdle;  // Longest the network task sleeps without an event
+    } schedule;
+
+    struct {
+        uint8_t mode;  // PowerMode
+        uint16_t minCpuMhz;
+        uint16_t maxCpuMhz;
+    } power;
+
+    struct {
+        ReportConfig temperature;
+        ReportConfig humidity;
+    } sensors;
+
+    struct {
+        FileNameString caCert;
+        FileNameString clientCert;
+        FileNameString privateKey;
+    } certs;
+};
 
 class ConfigLoader {
 private:
-    static JsonDocument config;
+    static DeviceConfig config;
+
+    static void applyDefaults();
+    static bool parseJson(File& file, bool& valid);
+    static uint32_t fileCrc(File& file);
+    static bool loadSnapshot(uint32_t sourceCrc);
+    static void saveSnapshot(uint32_t sourceCrc);
 
 public:
+    // False only when config.json cannot be read or parsed and the defaults are in use;
+    // individual invalid values are replaced by defaults and reported on Serial
     static bool loadConfig();
-    static String getWiFiSSID();
-    static String getWiFiPassword();
-    static String getMQTTBroker();
+    static const DeviceConfig& get() { return config; }
+
+    static const char* getWiFiSSID();
+    static const char* getWiFiPassword();
+    static const char* getMQTTBroker();
     static int getMQTTPort();
-    static String getMQTTClientId();
-    static String getMQTTUsername();
-    static String getMQTTPassword();
+    static const char* getMQTTClientId();
+    static const char* getMQTTUsername();
+    static const char* getMQTTPassword();
     static void getEthernetMAC(byte mac[6]);
     static IPAddress getEthernetIP();
     static IPAddress getEthernetGateway();
@@ -30,9 +156,18 @@ public:
     static IPAddress getEthernetStaticDNS1();
     static IPAddress getEthernetStaticDNS2();
 
-    static String getLTEAPN();
-    static String getLTEUser();
-    static String getLTEPass();
+    static size_t getNetworkInterfaceCount();
+    static NetInterface getNetworkInterface(size_t index);
+    static unsigned long getNetworkProbeInterval();
+    static unsigned long getNetworkProbeTimeout();
+    static const LinkWeights& getNetworkWeights();
+    static uint8_t getNetworkHysteresis();
+    static unsigned long getNetworkHoldTime();
+    static const ReconnectConfig& getNetworkReconnect();
+
+    static const char* getLTEAPN();
+    static const char* getLTEUser();
+    static const char* getLTEPass();
 
     static bool getWiFiStaticIPEnabled();
     static IPAddress getWiFiStaticIP();
@@ -41,18 +176,53 @@ public:
     static IPAddress getWiFiStaticDNS1();
     static IPAddress getWiFiStaticDNS2();
 
-    static String getMQTTStatusTopic();
-    static String getMQTTCommandTopic();
-    static String getMQTTSensorTopic();
-    static String getMQTTHeartbeatTopic();
+    static const char* getMQTTStatusTopic();
+    static const char* getMQTTCommandTopic();
+    static const char* getMQTTSensorTopic();
+    static const char* getMQTTHeartbeatTopic();
+    static const char* getMQTTMetricsTopic();
+
+    static uint8_t getMQTTQoS();
+    static size_t getMQTTInflightWindow();
+    static unsigned long getMQTTAckTimeout();
+    static const ReconnectConfig& getMQTTReconnect();
+    static uint16_t getMQTTKeepAlive();
+    static size_t getMQTTSubscriptionCount();
+    static const char* getMQTTSubscription(size_t index);
+    static PayloadFormat getMQTTStatusFormat();
+    static PayloadFormat getMQTTCommandFormat();
+    static PayloadFormat getMQTTSensorFormat();
+    static PayloadFormat getMQTTHeartbeatFormat();
+    static PayloadFormat getMQTTMetricsFormat();
+    static bool getMQTTOutboxEnabled();
+    static size_t getMQTTOutboxMaxBytes();
+    static size_t getMQTTOutboxSegmentSize();
+    static size_t getMQTTOutboxReplayBatch();
+    static unsigned long getMQTTOutboxReplayInterval();
+
+    static size_t getMQTTBatchSize();
+    static unsigned long getMQTTBatchMaxAge();
+
+    static unsigned long getSamplePeriod();
+    static unsigned long getHeartbeatInterval();
+    static unsigned long getStatusInterval();
+    static unsigned long getMetricsInterval();
+    static unsigned long getMaxIdle();
+
+    static PowerMode getPowerMode();
+    static uint16_t getPowerMinCpuMhz();
+    static uint16_t getPowerMaxCpuMhz();
 
-    static String getCACertFilename();
-    static String getClientCertFilename();
-    static String getPrivateKeyFilename();
+    static float getTemperatureDeadband();
+    static unsigned long getTemperatureMinInterval();
+    static unsigned long getTemperatureMaxInterval();
+    static float getHumidityDeadband();
+    static unsigned long getHumidityMinInterval();
+    static unsigned long getHumidityMaxInterval();
 
-    static String loadCACert();
-    static String loadClientCert();
-    static String loadPrivateKey();
+    static const char* getCACertFilename();
+    static const char* getClientCertFilename();
+    static const char* getPrivateKeyFilename();
 };
 
-#endif // CONFIG_LOADER_H
\ No newline at end of file
+#endif // CONFIG_LOADER_H
@@ -0,0 +1,57 @@
+#ifndef CREDENTIAL_STORE_H
+#define CREDENTIAL_STORE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <NetworkClientSecure.h>
+
+// Keeps the TLS CA certificate, client certificate and private key in
+// long-lived buffers so NetworkClientSecure can hold on to the pointers.
+// Files are read once and only re-read when their size or mtime changes.
+class CredentialStore {
+public:
+    static const size_t MAX_FILE_SIZE = 8192;
+
+private:
+    enum Kind {
+        CERTIFICATE,
+        PRIVATE_KEY
+    };
+
+    struct Credential {
+        const char* label;
+        Kind kind;
+        char* data;          // NUL-terminated PEM, stable until the file changes
+        size_t length;
+        size_t fileSize;
+        time_t lastWrite;
+    };
+
+    Credential caCert;
+    Credential clientCert;
+    Credential privateKey;
+    bool loaded;
+
+    bool load(Credential& cred, const char* filename);
+    bool hasChanged(const Credential& cred, const char* filename);
+    void release(Credential& cred);
+
+    static bool isPEM(const char* text);
+    static const char* derLabel(Kind kind, const uint8_t* data, size_t size);
+    static char* derToPEM(const char* label, const uint8_t* data, size_t size, size_t& length);
+
+public:
+    CredentialStore();
+    ~CredentialStore();
+
+    bool load();
+    bool refreshIfChanged();
+    void apply(NetworkClientSecure& client);
+    bool isLoaded() const { return loaded; }
+
+    const char* getCACert() const { return caCert.data; }
+    const char* getClientCert() const { return clientCert.data; }
+    const char* getPrivateKey() const { return privateKey.data; }
+};
+
+#endif // CREDENTIAL_STORE_H
@@ -0,0 +1,54 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <stddef.h>
+#include <string.h>
+
+// NUL-terminated string stored inline in Size bytes, so it holds at most
+// Size - 1 characters and never touches the heap. Plain data with the same
+// layout as char[Size], which keeps structs that contain it safe to
+// memcpy to and from flash.
+template <size_t Size>
+class FixedString {
+    static_assert(Size >= 2, "FixedString needs room for a character and the terminator");
+
+private:
+    char data[Size] = {};
+
+public:
+    static constexpr size_t capacity() { return Size - 1; }
+
+    // Copies str if it fits; otherwise leaves the string empty and returns
+    // false, since a truncated host, topic or password is never what was meant
+    bool assign(const char* str) {
+        size_t length = str ? strlen(str) : 0;
+        if (length > capacity()) {
+            data[0] = '\0';
+            return false;
+        }
+        memcpy(data, str ? str : "", length + 1);
+        return true;
+    }
+
+    void clear() { data[0] = '\0'; }
+
+    const char* c_str() const { return data; }
+    size_t length() const { return strlen(data); }
+    bool isEmpty() const { return data[0] == '\0'; }
+
+    bool operator==(const char* other) const { return other && strcmp(data, other) == 0; }
+    bool operator!=(const char* other) const { return !(*this == other); }
+};
+
+// Shared by DeviceConfig and the modules that keep a copy, so a value that
+// passed ConfigLoader's length checks always fits
+typedef FixedString<33> SSIDString;          // 802.11 allows 32 bytes
+typedef FixedString<65> PassphraseString;    // WPA2: 63 characters or 64 hex digits
+typedef FixedString<64> HostString;
+typedef FixedString<64> CredentialString;    // MQTT client ID, user name and password
+typedef FixedString<64> TopicString;         // Topic names and subscription filters
+typedef FixedString<64> APNString;
+typedef FixedString<32> LTECredentialString;
+typedef FixedString<32> FileNameString;
+
+#endif // FIXED_STRING_H
@@ -0,0 +1,92 @@
+#ifndef INFLIGHT_WINDOW_H
+#define INFLIGHT_WINDOW_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include "Metrics.h"
+
+#define INFLIGHT_SLOT_SIZE 1024  // Matches MQTT_BUFFER_SIZE
+
+struct InflightStats {
+    uint32_t sent;
+    uint32_t acked;
+    uint32_t retransmitted;
+    uint32_t lastAckMs;
+    uint32_t maxAckMs;
+};
+
+// Called with each SUBACK; refused is set if the broker rejected any filter
+typedef void (*SubackObserver)(void* context, uint16_t packetId, bool refused);
+
+// QoS 1 publishes awaiting PUBACK. Each slot keeps the encoded PUBLISH packet
+// so it can be resent unchanged (with DUP set) after a reconnect. Inbound
+// bytes are scanned for PUBACKs and SUBACKs, which PubSubClient reads but ignores.
+class InflightWindow {
+public:
+    static const size_t MAX_WINDOW = 8;
+
+private:
+    struct Slot {
+        bool used;
+        uint16_t packetId;
+        uint16_t length;
+        uint32_t sequence;  // Send order, used to retransmit oldest first
+        unsigned long sentAt;
+        uint8_t packet[INFLIGHT_SLOT_SIZE];
+    };
+
+    enum ScanState : uint8_t {
+        SCAN_TYPE,
+        SCAN_LENGTH,
+        SCAN_BODY
+    };
+
+    Slot slots[MAX_WINDOW];
+    size_t windowSize;
+    size_t count;
+    uint32_t sequence;
+    unsigned long ackTimeout;
+    InflightStats stats;
+    Histogram ackTime;  // Send to PUBACK, ms
+
+    // Inbound packet framing
+    ScanState scanState;
+    uint8_t scanType;
+    uint32_t scanRemaining;
+    uint32_t scanMultiplier;
+    uint8_t scanLengthBytes;
+    uint16_t scanId;
+    uint8_t scanIdBytes;
+    bool scanRefused;
+
+    SubackObserver subackObserver;
+    void* subackContext;
+
+    void acknowledge(uint16_t packetId);
+
+public:
+    InflightWindow();
+
+    // A window of 0 disables QoS 1
+    void configure(size_t windowSize, unsigned long ackTimeout);
+    bool isEnabled() const { return windowSize > 0; }
+    bool hasRoom() const { return count < windowSize; }
+    bool contains(uint16_t packetId) const;
+    static bool fits(size_t topicLength, size_t payloadLength);
+
+    // Stores and writes a PUBLISH; it stays in the window until acknowledged,
+    // even if the write fails
+    bool send(Client& client, const char* topic, const uint8_t* payload, size_t length, uint16_t packetId);
+    size_t resend(Client& client);
+    bool isStalled(unsigned long now) const;
+
+    void resetScanner();
+    void scan(const uint8_t* data, size_t length);
+    void setSubackObserver(SubackObserver observer, void* context);
+
+    size_t size() const { return count; }
+    const InflightStats& getStats() const { return stats; }
+    Histogram& getAckHistogram() { return ackTime; }
+};
+
+#endif // INFLIGHT_WINDOW_H
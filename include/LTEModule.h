@@ -1,21 +1,24 @@
 #ifndef LTE_MODULE_H
 #define LTE_MODULE_H
 
-#include <HardwareSerial.h>
 #include <PPP.h>
 #include <Arduino.h>
+#include "FixedString.h"
+#include "board.h"
 
 class LTEModule {
 private:
-    HardwareSerial* serial;
-    String apn;
-    String user;
-    String pass;
+    int tx, rx, rts, cts, rst;
+    APNString apn;
+    LTECredentialString user;
+    LTECredentialString pass;
     bool connected;
 
 public:
-    LTEModule(HardwareSerial* serial, int rst = -1, int tx = -1, int rx = -1, int rts = -1, int cts = -1);
-    void setAPN(const String& apn, const String& user = "", const String& pass = "");
+    // PPP drives the UART itself; nothing touches the modem until begin()
+    LTEModule(int tx = LTE_TX_PIN, int rx = LTE_RX_PIN, int rts = -1, int cts = -1, int rst = -1);
+    void begin();
+    bool setAPN(const char* apn, const char* user = "", const char* pass = "");
     bool connect();
     void disconnect();
     bool isConnected();
@@ -2,53 +2,185 @@
 #define MQTT_MODULE_H
 
 #include <PubSubClient.h>
-#include <NetworkClientSecure.h>
+#include <lwip/ip_addr.h>
+#include "SecureSessionClient.h"
 #include "NetworkController.h"
 #include "ConfigLoader.h"
+#include "MQTTOutbox.h"
+#include "CredentialStore.h"
+#include "TopicTrie.h"
+#include "InflightWindow.h"
+#include "Backoff.h"
+#include "Metrics.h"
+#include "FixedString.h"
+
+// Steps of a connection attempt; update() advances at most one per call
+enum MQTTConnectionState {
+    MQTT_STATE_IDLE,
+    MQTT_STATE_RESOLVING,
+    MQTT_STATE_TCP_CONNECTING,
+    MQTT_STATE_TLS_HANDSHAKE,
+    MQTT_STATE_CONNECTING,
+    MQTT_STATE_SUBSCRIBING,
+    MQTT_STATE_CONNECTED
+};
+
+#define MQTT_BUFFER_SIZE 1024  // Fits a full SensorBatch or status message plus topic and header
+#define MQTT_STREAM_CHUNK 256  // Copy size for streamed publishes
+#define MQTT_CONNECT_POLL 5    // ms between update() calls while a connection attempt is in progress
 
 class MQTTModule {
 private:
-    PubSubClient* mqttClient;
-    NetworkClientSecure netClient;
+    SecureSessionClient netClient;
+    PubSubClient mqttClient;
     NetworkController* netController;
-    String broker;
+    HostString broker;
     int port;
-    String clientId;
-    String username;
-    String password;
+    CredentialString clientId;
+    CredentialString username;
+    CredentialString password;
     bool connected;
+    bool lastConnectFailed;
+    MQTTConnectionState state;
+    unsigned long stateStarted;
+    Backoff retry;                 // Delay before the next connection attempt
+    bool reconnectNow;             // Skip the backoff after the network moved interfaces
+    NetInterface sessionInterface; // Interface the current session runs over
+    unsigned long outageStarted;   // When the last session was lost, 0 if never
+    uint32_t lastOutageMs;
+
+    // Per-state time limits for a connection attempt
+    const unsigned long resolveTimeout = 5000;
+    const unsigned long tcpTimeout = 5000;
+    const unsigned long handshakeTimeout = 10000;
+    const uint16_t connackTimeout = 3;  // seconds, PubSubClient socket timeout
+    const unsigned long subackTimeout = 10000;
+    uint16_t keepAlive;                 // seconds
+
+    // Asynchronous DNS lookup, completed from the lwIP thread
+    volatile uint8_t dnsStatus;
+    volatile uint32_t dnsAddress;
+    CredentialStore credentials;
 
     // Configurable topics
-    String statusTopic;
-    String commandTopic;
-    String sensorTopic;
-    String heartbeatTopic;
+    TopicString statusTopic;
+    TopicString commandTopic;
+    TopicString sensorTopic;
+    TopicString heartbeatTopic;
+    TopicString metricsTopic;
+    PayloadFormat heartbeatFormat;
 
-    void callback(char* topic, byte* payload, unsigned int length);
+    // Store-and-forward for publishes made while disconnected
+    MQTTOutbox outbox;
+    size_t replayBatch;
+    unsigned long replayInterval;
+    unsigned long lastReplay;
+
+    // QoS 1 publishes waiting for PUBACK, resent after a reconnect
+    InflightWindow inflight;
+
+    // Recorded here, published through MetricsRegistry
+    Histogram handshakeTime;     // TLS handshake, ms
+    Histogram reconnectTime[3];  // Session lost to reconnected, ms, per NetInterface
+    Counter publishesSent;
+    Counter publishesQueued;
+    Counter publishesRejected;   // Too large to ever send, so never queued
+    Counter connectFailures;
+
+    // Set between beginPublish() and endPublish(); nothing else may write to the socket
+    bool streaming;
+    size_t streamRemaining;
+
+    MQTTMessageCallback commandCallback;
+
+    // Every filter is restored with one SUBSCRIBE after a reconnect
+    TopicTrie subscriptions;
+    uint16_t packetId;
+    bool subackWaiting;            // A SUBSCRIBE has not been acknowledged yet
+    uint16_t subackPending;        // Packet ID of the latest SUBSCRIBE
+    unsigned long subackSentAt;    // When the oldest unacknowledged SUBSCRIBE went out
+
+    uint16_t nextPacketId();
+    bool canEverSend(const char* topic, size_t length) const;
+    bool sendPublish(const char* topic, const uint8_t* payload, size_t length);
+    static void onSocketRead(void* context, const uint8_t* data, size_t length);
+    static void onSuback(void* context, uint16_t packetId, bool refused);
+    bool sendSubscribe(size_t first, size_t count);
+
+    void enterState(MQTTConnectionState next);
+    unsigned long stateTimeout() const;
+    void stepConnection();
+    void failConnection(const char* reason);
+    void handleConnectionLost();
+    void startResolve();
+
+    static void lookupHost(void* arg);
+    static void dnsFound(const char* name, const ip_addr_t* address, void* arg);
 
 public:
     MQTTModule(NetworkController* net);
-    ~MQTTModule();
 
-    void setBroker(const String& broker, int port = 8883);
-    void setCredentials(const String& clientId, const String& username = "", const String& password = "");
-    void setTopics(const String& status, const String& command, const String& sensor, const String& heartbeat);
+    // Each returns false, and logs, if a value does not fit; that value is left empty
+    bool setBroker(const char* broker, int port = 8883);
+    bool setCredentials(const char* clientId, const char* username = "", const char* password = "");
+    bool setTopics(const char* status, const char* command, const char* sensor, const char* heartbeat);
+    void setHeartbeatFormat(PayloadFormat format);
+    bool setMetricsTopic(const char* topic);
     void setCACert(const char* caCert);
     void loadCertsFromSPIFFS();
+    void setCommandCallback(MQTTMessageCallback cb);
+    void setOutbox(size_t maxBytes, size_t segmentSize, size_t replayBatch, unsigned long replayInterval);
+    void setDelivery(uint8_t qos, size_t inflightWindow, unsigned long ackTimeout);
+    void setReconnect(unsigned long baseDelay, unsigned long maxDelay);
+    void setKeepAlive(uint16_t seconds);
 
     bool connect();
     void disconnect();
     bool isConnected();
+    MQTTConnectionState getConnectionState() const { return state; }
     void update();
 
     bool publish(const char* topic, const char* payload);
+    bool publish(const char* topic, const uint8_t* payload, size_t length);
+    // Streamed QoS 0 publish of a payload whose length is known up front. The
+    // payload goes straight to the socket, so it is never held in RAM; it is not
+    // queued in the outbox if the broker is unreachable.
+    bool beginPublish(const char* topic, size_t length);
+    size_t write(const uint8_t* data, size_t length);
+    bool endPublish();
+    bool publishStream(const char* topic, Stream& source, size_t length);
+    bool publishFile(const char* topic, const char* path);
+
+    bool subscribe(const char* filter, MQTTMessageCallback handler);
     bool subscribe(const char* topic);
+    // Routes an inbound PUBLISH to the matching handlers; PubSubClient calls
+    // it from loop(), the benchmarks call it directly
+    void callback(char* topic, byte* payload, unsigned int length);
 
     // Convenience methods for configured topics
-    bool publishStatus(const String& message);
-    bool publishSensor(const String& sensorData);
+    bool publishStatus(const char* payload, size_t length);
+    bool publishSensor(const char* payload, size_t length);
     bool publishHeartbeat();
+    static bool formatHeartbeat(PayloadWriter& writer, unsigned long timestamp);
+    bool publishMetrics(const char* payload, size_t length);
     bool subscribeToCommands();
+
+    const MQTTOutbox& getOutbox() const { return outbox; }
+    const TLSHandshakeStats& getTLSStats() const { return netClient.getStats(); }
+    const InflightStats& getDeliveryStats() const { return inflight.getStats(); }
+    uint32_t getLastOutageMs() const { return lastOutageMs; }
+    uint32_t getReconnectAttempts() const { return retry.getFailures(); }
+
+    // For the network task's wait: the MQTT socket (-1 when closed), whether
+    // TLS already holds decrypted bytes select() cannot see, and how long
+    // update() can go uncalled before it has work to do
+    int getSocket() { return connected ? netClient.fd() : -1; }
+    bool hasPendingInput() { return connected && netClient.available() > 0; }
+    unsigned long getPollDelay(unsigned long now) const;
+    size_t getInflightCount() const { return inflight.size(); }
+
+    // Adds this module's instruments; reconnect times only for enabled interfaces
+    void registerMetrics(MetricsRegistry& registry);
 };
 
 #endif // MQTT_MODULE_H
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef MQTT_OUTBOX_H
+#define MQTT_OUTBOX_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <functional>
+
+// Store-and-forward queue for publishes made while the broker is unreachable.
+// Records are appended to numbered segment files under /outbox. The oldest
+// segment is discarded when the configured size limit would be exceeded.
+class MQTTOutbox {
+public:
+    enum ReplayResult {
+        REPLAY_SENT,
+        REPLAY_RETRY,     // Not now; the record stays at the head
+        REPLAY_REJECTED   // Can never be sent; the record is dropped
+    };
+    typedef std::function<ReplayResult(const char* topic, const uint8_t* payload, size_t length)> ReplaySink;
+
+    static const size_t MAX_TOPIC_LENGTH = 128;
+    static const size_t MAX_PAYLOAD_LENGTH = 1024;
+
+private:
+    struct RecordHeader {
+        uint8_t magic;
+        uint8_t reserved;
+        uint16_t topicLength;
+        uint16_t payloadLength;
+    };
+
+    static const uint8_t RECORD_MAGIC = 0xA5;
+
+    bool enabled;
+    size_t maxBytes;
+    size_t segmentSize;
+
+    uint32_t headSegment;  // Oldest segment that still holds unsent records
+    uint32_t headOffset;   // Read position inside the head segment
+    uint32_t tailSegment;  // Segment currently being appended to
+    uint32_t tailSize;
+
+    uint32_t depth;
+    uint32_t bytesStored;
+    uint32_t dropped;
+
+    char topicBuffer[MAX_TOPIC_LENGTH + 1];
+    uint8_t payloadBuffer[MAX_PAYLOAD_LENGTH];
+
+    String segmentPath(uint32_t segment);
+    void saveHead();
+    void loadHead();
+    uint32_t countRecords(uint32_t segment, uint32_t offset);
+    void dropHeadSegment();
+    void advanceHead();
+
+public:
+    MQTTOutbox();
+
+    bool begin(size_t maxBytes, size_t segmentSize);
+    bool isEnabled() const { return enabled; }
+
+    bool enqueue(const char* topic, const uint8_t* payload, size_t length);
+    // Returns the number of records sent; rejected ones count as dropped
+    size_t replay(size_t maxMessages, const ReplaySink& sink);
+    void clear();
+
+    uint32_t getDepth() const { return depth; }
+    uint32_t getBytesStored() const { return bytesStored; }
+    uint32_t getDropped() const { return dropped; }
+};
+
+#endif // MQTT_OUTBOX_H
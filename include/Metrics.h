@@ -0,0 +1,102 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include "PayloadWriter.h"
+
+#define METRICS_PAYLOAD_SIZE 960  // Fits MQTT_BUFFER_SIZE with topic and header
+
+// Instruments are plain objects owned by the module that records them; a
+// record is one or two relaxed atomic operations, so they can sit on hot
+// paths and on any task. MetricsRegistry only keeps names and pointers for
+// encoding snapshots.
+
+class Counter {
+private:
+    std::atomic<uint32_t> value;
+
+public:
+    Counter() : value(0) {}
+    void add(uint32_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint32_t get() const { return value.load(std::memory_order_relaxed); }
+};
+
+class Gauge {
+private:
+    std::atomic<int32_t> value;
+
+public:
+    Gauge() : value(0) {}
+    void set(int32_t v) { value.store(v, std::memory_order_relaxed); }
+    int32_t get() const { return value.load(std::memory_order_relaxed); }
+};
+
+// Fixed upper bounds, ascending; values above the last bound land in an
+// overflow bucket. Buckets, count and sum are cleared by each snapshot.
+class Histogram {
+public:
+    static const uint8_t MAX_BOUNDS = 8;
+
+private:
+    const uint32_t* bounds;
+    uint8_t boundCount;
+    std::atomic<uint32_t> buckets[MAX_BOUNDS + 1];
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> sum;
+    std::atomic<uint32_t> max;
+
+public:
+    Histogram(const uint32_t* bounds, uint8_t boundCount);
+
+    void record(uint32_t value) {
+        uint8_t i = 0;
+        while (i < boundCount && value > bounds[i]) i++;
+        buckets[i].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        // Lost races only ever under-report the max by one concurrent sample
+        if (value > max.load(std::memory_order_relaxed)) max.store(value, std::memory_order_relaxed);
+    }
+
+    // Writes {"n","sum","max","b":[buckets]} and clears the interval; bounds are fixed per build
+    void snapshot(PayloadWriter& writer, const char* name);
+};
+
+class MetricsRegistry {
+public:
+    static const size_t MAX_METRICS = 24;
+
+private:
+    enum Kind : uint8_t { METRIC_COUNTER, METRIC_GAUGE, METRIC_HISTOGRAM };
+
+    struct Entry {
+        const char* name;  // Must outlive the registry; string literals in practice
+        Kind kind;
+        void* instrument;
+    };
+
+    Entry entries[MAX_METRICS];
+    size_t count;
+
+    bool add(const char* name, Kind kind, void* instrument);
+
+public:
+    MetricsRegistry();
+
+    bool add(const char* name, Counter& counter) { return add(name, METRIC_COUNTER, &counter); }
+    bool add(const char* name, Gauge& gauge) { return add(name, METRIC_GAUGE, &gauge); }
+    bool add(const char* name, Histogram& histogram) { return add(name, METRIC_HISTOGRAM, &histogram); }
+
+    // One object keyed by metric name; call from a single task
+    bool snapshot(PayloadWriter& writer);
+    size_t size() const { return count; }
+};
+
+// Shared bucket bounds
+extern const uint32_t LATENCY_MS_BOUNDS[8];    // Round trips and handshakes
+extern const uint32_t RECONNECT_MS_BOUNDS[6];  // Outages
+extern const uint32_t LOOP_US_BOUNDS[6];       // Task iterations
+
+#endif // METRICS_H
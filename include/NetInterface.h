@@ -0,0 +1,21 @@
+#ifndef NET_INTERFACE_H
+#define NET_INTERFACE_H
+
+// Network types shared by the config snapshot, NetworkController and
+// PowerManager, kept apart so the config layer needs no network headers
+
+enum NetInterface {
+    ETHERNET,
+    WIFI,
+    LTE
+};
+
+// Cost per unit of each link measurement; the score is 100 minus the total cost
+struct LinkWeights {
+    float rtt;       // Per 10 ms of probe round trip
+    float loss;      // Per percent of failed probes
+    float signal;    // Per dB below -50 dBm (WiFi RSSI, LTE signal)
+    float priority;  // Per position down the configured interface list
+};
+
+#endif // NET_INTERFACE_H
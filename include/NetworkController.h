@@ -2,15 +2,16 @@
 #define NETWORK_CONTROLLER_H
 
 #include <Arduino.h>
-#include <WiFi.h>
-#include <ETH.h>
-#include <vector>
-
-enum NetInterface {
-    ETHERNET,
-    WIFI,
-    LTE
-};
+#include "board.h"
+#include "NetInterface.h"
+#include "Backoff.h"
+#include "WiFiModule.h"
+#if BOARD_HAS_ETHERNET
+#include "EthernetModule.h"
+#endif
+#if BOARD_HAS_LTE
+#include "LTEModule.h"
+#endif
 
 enum NetworkState {
     DISCONNECTED,
@@ -20,34 +21,89 @@ enum NetworkState {
 
 typedef void (*NetworkEventCallback)(NetInterface interface);
 
-class WiFiModule;
-class EthernetModule;
-class LTEModule;
+#define PROBE_POLL 5  // ms between update() calls while a probe connect is outstanding
 
+// Keeps every interface in priorityOrder up at once. Each link is probed with
+// a TCP connect to the broker through that interface and scored from probe
+// RTT, probe loss, signal strength and list position. Traffic moves to a
+// standby as soon as the current link drops (make-before-break), and to a
+// better scoring link once it beats the current one by the hysteresis margin.
+// Only the interfaces board.h marks as fitted are compiled in; the others have
+// no module, no Link slot and no case in the per-interface switches.
 class NetworkController {
+public:
+    static constexpr size_t LINK_COUNT = 1 + BOARD_HAS_ETHERNET + BOARD_HAS_LTE;
+
+    static constexpr bool isFitted(NetInterface interface) {
+        return interface == WIFI || (interface == ETHERNET && BOARD_HAS_ETHERNET) || (interface == LTE && BOARD_HAS_LTE);
+    }
+
 private:
+    struct Link {
+        bool up;                    // Link and IP address present
+        bool reachable;             // Last probe reached the broker over this link
+        int probeSocket;            // -1 while no probe is running
+        unsigned long probeStarted;
+        unsigned long lastProbe;
+        Backoff retry;              // Bring-up attempts while the link is down
+        uint32_t probes;            // Completed probes since the link came up
+        float rttMs;                // Smoothed probe connect time
+        float loss;                 // Smoothed probe failure rate, percent
+        int signal;                 // dBm, 0 where not applicable
+        uint8_t score;              // 0-100, higher is better
+    };
+
     NetInterface currentInterface;
     NetworkState state;
     NetworkEventCallback onConnectedCallback;
     NetworkEventCallback onDisconnectedCallback;
 
-    WiFiModule* wifi;
-    EthernetModule* ethernet;
-    LTEModule* lte;
-
-    std::vector<NetInterface> priorityOrder = {ETHERNET, WIFI, LTE};
-    int retryCount;
-    const int maxRetries = 3;
-    unsigned long lastRetryTime;
-    const unsigned long retryDelay = 5000; // 5 seconds
-
-    static NetworkController* instance;
-
-    void attemptConnection(NetInterface interface);
-    void checkConnection();
-    void triggerFailover();
-
-    static void networkEventHandler(arduino_event_id_t event, arduino_event_info_t info);
+    WiFiModule wifi;
+#if BOARD_HAS_ETHERNET
+    EthernetModule ethernet;
+#endif
+#if BOARD_HAS_LTE
+    LTEModule lte;
+#endif
+
+    NetInterface priorityOrder[LINK_COUNT];  // Fitted interfaces only
+    size_t priorityCount;
+    Link links[LINK_COUNT];  // Indexed by slotOf()
+
+    // Fitted interfaces packed in NetInterface order
+    static constexpr size_t slotOf(NetInterface interface) {
+        return interface == ETHERNET ? 0 : interface == WIFI ? BOARD_HAS_ETHERNET : BOARD_HAS_ETHERNET + 1;
+    }
+    Link& linkFor(NetInterface interface) { return links[slotOf(interface)]; }
+    const Link& linkFor(NetInterface interface) const { return links[slotOf(interface)]; }
+
+    // Standby reachability probes
+    IPAddress probeAddress;
+    uint16_t probePort;
+    unsigned long probeInterval;
+    unsigned long probeTimeout;
+
+    // Link selection
+    LinkWeights weights;
+    uint8_t hysteresis;
+    unsigned long holdTime;
+    unsigned long lastSwitch;
+
+    // Failover timing
+    unsigned long linkLostAt;
+    uint32_t failoverCount;
+    uint32_t lastFailoverMs;
+
+    bool isLinkUp(NetInterface interface);
+    void bringUp(NetInterface interface);
+    void makeDefault(NetInterface interface);
+    void switchTo(NetInterface interface, unsigned long now);
+    void stepProbe(NetInterface interface, unsigned long now);
+    void startProbe(NetInterface interface, unsigned long now);
+    void finishProbe(NetInterface interface, bool reachable, unsigned long now);
+    int readSignal(NetInterface interface);
+    void updateScore(NetInterface interface);
+    bool findBest(NetInterface& best, bool verifiedOnly) const;
 
 public:
     NetworkController();
@@ -59,14 +115,36 @@ public:
     void setOnConnectedCallback(NetworkEventCallback cb);
     void setOnDisconnectedCallback(NetworkEventCallback cb);
 
-    void setWiFiCredentials(const String& ssid, const String& password);
+    bool setWiFiCredentials(const char* ssid, const char* password);
     void setWiFiStaticIP(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2);
+#if BOARD_HAS_ETHERNET
     void setEthernetConfig(byte mac[6], IPAddress ip, IPAddress gateway, IPAddress subnet);
     void setEthernetStaticIP(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2);
-    void setLTEAPN(const String& apn, const String& user = "", const String& pass = "");
+#endif
+#if BOARD_HAS_LTE
+    bool setLTEAPN(const char* apn, const char* user = "", const char* pass = "");
+#endif
+
+    // Interfaces to keep up, highest priority first; ones not fitted are dropped
+    void setPriority(const NetInterface* order, size_t count);
+    // Broker address used to verify standby links; probing is off until set
+    void setProbeTarget(IPAddress address, uint16_t port);
+    void setProbeTiming(unsigned long interval, unsigned long timeout);
+    void setSelection(const LinkWeights& weights, uint8_t hysteresis, unsigned long holdTime);
+    void setReconnect(unsigned long baseDelay, unsigned long maxDelay);
 
     NetInterface getCurrentInterface();
     NetworkState getState();
+    bool isStandbyReady(NetInterface interface) const;
+    bool isLinkEnabled(NetInterface interface) const;
+    // How long update() can go uncalled before a probe or bring-up is due;
+    // link state changes wake the network task through WiFi/ETH/PPP events
+    unsigned long getPollDelay(unsigned long now) const;
+    uint8_t getScore(NetInterface interface) const { return isFitted(interface) ? linkFor(interface).score : 0; }
+    uint32_t getFailoverCount() const { return failoverCount; }
+    uint32_t getLastFailoverMs() const { return lastFailoverMs; }
+
+    static const char* interfaceName(NetInterface interface);
 };
 
 #endif // NETWORK_CONTROLLER_H
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef PAYLOAD_WRITER_H
+#define PAYLOAD_WRITER_H
+
+#include <Arduino.h>
+
+enum PayloadFormat {
+    PAYLOAD_JSON,
+    PAYLOAD_MSGPACK
+};
+
+// Builds JSON or MessagePack messages into a caller-provided buffer without
+// touching the heap. Once the buffer is full further writes are ignored and
+// ok() returns false. c_str() is only meaningful for JSON; binary payloads
+// must be sent with size().
+class PayloadWriter {
+public:
+    static const uint8_t MAX_DEPTH = 8;
+
+private:
+    char* buffer;
+    size_t capacity;
+    size_t length;
+    bool overflow;
+    PayloadFormat format;
+
+    // MessagePack containers are prefixed with their element count, which is
+    // patched in when the container is closed
+    uint8_t depth;
+    uint16_t containerStart[MAX_DEPTH];
+    uint16_t containerCount[MAX_DEPTH];
+
+    void put(char c);
+    void put(const char* str, size_t len);
+    void separator();
+    void key(const char* name);
+    void putInteger(long long value);
+    void putUnsigned(unsigned long long value);
+    void putFloat(double value, uint8_t decimals);
+    void putString(const char* str);
+
+    void packNumber(uint8_t marker, unsigned long long value, size_t bytes);
+    void packUnsigned(unsigned long long value);
+    void packInteger(long long value);
+    void packFloat(double value);
+    void packString(const char* str);
+    void openContainer(uint8_t marker);
+    void closeContainer(uint8_t fixMarker, uint8_t fixLimit);
+
+public:
+    PayloadWriter(char* buffer, size_t capacity, PayloadFormat format = PAYLOAD_JSON);
+
+    void reset();
+
+    void beginObject();
+    void beginObject(const char* name);
+    void endObject();
+    void beginArray(const char* name);
+    void endArray();
+
+    // Object members
+    void add(const char* name, const char* value);
+    void add(const char* name, bool value);
+    void add(const char* name, int value);
+    void add(const char* name, unsigned int value);
+    void add(const char* name, long value);
+    void add(const char* name, unsigned long value);
+    void add(const char* name, double value, uint8_t decimals = 2);
+
+    // Array elements
+    void add(const char* value);
+    void add(int value);
+    void add(unsigned int value);
+    void add(long value);
+    void add(unsigned long value);
+    void add(double value, uint8_t decimals = 2);
+
+    PayloadFormat getFormat() const { return format; }
+    bool ok() const { return !overflow; }
+    const char* c_str() const { return buffer; }
+    size_t size() const { return length; }
+};
+
+#endif // PAYLOAD_WRITER_H
@@ -0,0 +1,60 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "NetInterface.h"
+
+enum PowerMode {
+    POWER_PERFORMANCE,  // Radio always on, CPU at full clock
+    POWER_BALANCED,     // WiFi wakes every DTIM, CPU scales with load
+    POWER_LOW           // WiFi sleeps for the listen interval, light sleep between jobs
+};
+
+// Applies the configured power mode and tracks what it costs in latency.
+// Light sleep is only used while traffic runs over WiFi, which can wake the
+// CPU on its own; a W5500 on SPI or a modem on UART would miss traffic.
+// Automatic light sleep needs a core built with tickless idle; without it
+// POWER_LOW falls back to modem sleep and frequency scaling.
+class PowerManager {
+private:
+    PowerMode mode;
+    uint16_t minCpuMhz;
+    uint16_t maxCpuMhz;
+    bool lightSleepActive;
+    bool lightSleepSupported;
+    bool applied;
+    NetInterface appliedInterface;
+
+    // Network task only
+    uint32_t maxWakeLateMs;
+    // Written by the loop task, read by the network task
+    std::atomic<uint32_t> lastCommandMs;
+    std::atomic<uint32_t> maxCommandMs;
+
+    bool configurePm(bool lightSleep);
+
+public:
+    PowerManager();
+
+    void configure(PowerMode mode, uint16_t minCpuMhz, uint16_t maxCpuMhz);
+    void begin();
+    // Re-evaluates light sleep when traffic moves to another interface
+    void update(NetInterface current);
+
+    // Timed waits that returned late, e.g. from waking out of light sleep
+    void recordWait(uint32_t requestedMs, uint32_t actualMs);
+    // Time from onCommand() on the network task to dispatch on the loop task
+    void recordCommand(uint32_t latencyMs);
+
+    PowerMode getMode() const { return mode; }
+    bool isLightSleepActive() const { return lightSleepActive; }
+    uint32_t getMaxWakeLateMs() const { return maxWakeLateMs; }
+    uint32_t getLastCommandMs() const { return lastCommandMs.load(std::memory_order_relaxed); }
+    uint32_t takeMaxCommandMs() { return maxCommandMs.exchange(0, std::memory_order_relaxed); }
+    void resetWakeLate() { maxWakeLateMs = 0; }
+
+    static const char* modeName(PowerMode mode);
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,42 @@
+#ifndef REPORT_FILTER_H
+#define REPORT_FILTER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Report-by-exception for one sensor channel. A reading is reported when it
+// leaves the deadband around the last reported value (but not more often than
+// minInterval), or when maxInterval has passed without a report.
+// A maxInterval of 0 disables filtering.
+class ReportFilter {
+private:
+    float deadband;
+    unsigned long minInterval;
+    unsigned long maxInterval;
+
+    float lastValue;
+    unsigned long lastReportTime;
+    bool hasReported;
+
+    std::atomic<uint32_t> reported;
+    std::atomic<uint32_t> suppressed;
+
+public:
+    ReportFilter();
+
+    void configure(float deadband, unsigned long minInterval, unsigned long maxInterval);
+    bool isEnabled() const { return maxInterval > 0; }
+
+    bool wantsReport(float value, unsigned long now) const;
+    // This channel's change triggered the publish
+    void markReported(float value, unsigned long now);
+    // Published only because another channel changed; counts as neither sent
+    // nor suppressed, but the published value becomes the new reference
+    void markCarried(float value, unsigned long now);
+    void markSuppressed() { suppressed.fetch_add(1, std::memory_order_relaxed); }
+
+    uint32_t getReported() const { return reported.load(std::memory_order_relaxed); }
+    uint32_t getSuppressed() const { return suppressed.load(std::memory_order_relaxed); }
+};
+
+#endif // REPORT_FILTER_H
@@ -0,0 +1,70 @@
+#ifndef SECURE_SESSION_CLIENT_H
+#define SECURE_SESSION_CLIENT_H
+
+#include <NetworkClientSecure.h>
+#include <mbedtls/ssl.h>
+#include "FixedString.h"
+
+struct TLSHandshakeStats {
+    uint32_t full;
+    uint32_t resumed;
+    uint32_t lastFullMs;
+    uint32_t lastResumedMs;
+    uint32_t totalFullMs;
+    uint32_t totalResumedMs;
+};
+
+typedef void (*ReadObserver)(void* context, const uint8_t* data, size_t length);
+
+// NetworkClientSecure that keeps the negotiated TLS session between
+// connections and offers it to the broker on the next handshake. The cached
+// session survives stop() and interface changes; if the broker declines it,
+// mbedTLS falls back to a full handshake on its own.
+class SecureSessionClient : public NetworkClientSecure {
+private:
+    mbedtls_ssl_session session;
+    bool hasSession;
+    HostString sessionHost;
+    uint16_t sessionPort;
+    uint8_t sessionId[32];
+    size_t sessionIdLength;
+    TLSHandshakeStats stats;
+
+    // Connection currently being set up by beginConnect()/handshakeStep()
+    HostString pendingHost;  // Left empty for a host too long to cache a session for
+    uint16_t pendingPort;
+    bool pendingOffered;
+    unsigned long pendingStart;
+
+    ReadObserver readObserver;
+    void* readContext;
+
+    void saveSession(const char* host, uint16_t port);
+    void recordHandshake();
+    void setBlocking(bool blocking);
+
+public:
+    SecureSessionClient();
+    ~SecureSessionClient();
+
+    using NetworkClientSecure::connect;
+    int connect(const char* host, uint16_t port) override;
+
+    // Split connect: TCP and TLS setup first, then the handshake one step per call.
+    // beginConnect() waits for the TCP connect (bounded by the connection timeout);
+    // handshakeStep() never waits and returns 1 when done, 0 while waiting on
+    // the broker, -1 on failure. Needs mbedTLS 3 (arduino-esp32 v3).
+    int beginConnect(IPAddress ip, const char* host, uint16_t port);
+    int handshakeStep();
+
+    // Sees every decrypted byte handed to the reader (read() goes through read(buf, size))
+    void setReadObserver(ReadObserver observer, void* context);
+    int read(uint8_t* buf, size_t size) override;
+    using NetworkClientSecure::read;
+
+    void clearSession();
+    bool hasCachedSession() const { return hasSession; }
+    const TLSHandshakeStats& getStats() const { return stats; }
+};
+
+#endif // SECURE_SESSION_CLIENT_H
@@ -0,0 +1,42 @@
+#ifndef SENSOR_BATCH_H
+#define SENSOR_BATCH_H
+
+#include <Arduino.h>
+#include "PayloadWriter.h"
+
+// Collects DHT readings in RAM and encodes them as one message.
+// Each series starts with an absolute value followed by deltas from the
+// previous sample; readings are stored in tenths of a unit.
+class SensorBatch {
+public:
+    static const size_t MAX_SAMPLES = 16;
+    static const int SCALE = 10;
+
+private:
+    struct Sample {
+        uint32_t timestamp;
+        int16_t temperature;
+        int16_t humidity;
+    };
+
+    Sample samples[MAX_SAMPLES];
+    size_t count;
+    size_t limit;
+    unsigned long maxAge;
+
+public:
+    SensorBatch();
+
+    void configure(size_t size, unsigned long maxAge);
+    bool isEnabled() const { return limit > 1; }
+
+    void add(unsigned long timestamp, float temperature, float humidity);
+    bool isDue(unsigned long now) const;
+    bool encode(PayloadWriter& writer) const;
+    // The unbatched message: one reading with its own timestamp
+    static bool encodeReading(PayloadWriter& writer, unsigned long timestamp, float temperature, float humidity);
+    void clear() { count = 0; }
+    size_t size() const { return count; }
+};
+
+#endif // SENSOR_BATCH_H
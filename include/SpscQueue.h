@@ -0,0 +1,71 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+// Lock-free ring buffer for exactly one producer task and one consumer task.
+// Slots are written in place (prepare/commit) so large messages are never
+// copied through a temporary.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    T slots[Capacity];
+    std::atomic<size_t> head;  // Next slot to read, only advanced by the consumer
+    std::atomic<size_t> tail;  // Next slot to write, only advanced by the producer
+    std::atomic<size_t> dropped;
+
+public:
+    SpscQueue() : head(0), tail(0), dropped(0) {}
+
+    // Producer side: returns the next free slot, or nullptr when full
+    T* prepare() {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &slots[t & (Capacity - 1)];
+    }
+
+    void commit() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool push(const T& item) {
+        T* slot = prepare();
+        if (!slot) return false;
+        *slot = item;
+        commit();
+        return true;
+    }
+
+    // Consumer side: returns the oldest message, or nullptr when empty
+    T* front() {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return nullptr;
+        return &slots[h & (Capacity - 1)];
+    }
+
+    void release() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool pop(T& item) {
+        T* slot = front();
+        if (!slot) return false;
+        item = *slot;
+        release();
+        return true;
+    }
+
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    size_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+#endif // SPSC_QUEUE_H
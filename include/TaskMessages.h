@@ -0,0 +1,33 @@
+#ifndef TASK_MESSAGES_H
+#define TASK_MESSAGES_H
+
+#include <Arduino.h>
+#include "SpscQueue.h"
+
+#define TELEMETRY_PAYLOAD_SIZE  512
+#define COMMAND_TOPIC_SIZE      64
+#define COMMAND_PAYLOAD_SIZE    256
+
+enum TelemetryTopic {
+    TELEMETRY_SENSOR
+};
+
+// Preformatted publish handed from the sampling core to the network core
+struct TelemetryMessage {
+    uint8_t topic;
+    uint16_t length;
+    char payload[TELEMETRY_PAYLOAD_SIZE];
+};
+
+// Inbound MQTT message handed from the network core to command handling
+struct CommandMessage {
+    uint16_t length;
+    unsigned long receivedAt;
+    char topic[COMMAND_TOPIC_SIZE];
+    char payload[COMMAND_PAYLOAD_SIZE];
+};
+
+typedef SpscQueue<TelemetryMessage, 8> TelemetryQueue;
+typedef SpscQueue<CommandMessage, 4> CommandQueue;
+
+#endif // TASK_MESSAGES_H
@@ -0,0 +1,61 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef void (*TimerCallback)(void* context);
+
+// Periodic jobs on a three-level hierarchical timer wheel with 10 ms ticks.
+// Level 0 holds timers due within 64 ticks, level 1 within 64^2 and level 2
+// within 64^3 (about 43 minutes); higher levels are cascaded down as time
+// reaches them, so advancing costs one slot per tick however many timers
+// are armed. Callbacks run from advance() on the owning task.
+class TimerWheel {
+public:
+    static const size_t MAX_TIMERS = 8;
+    static const uint32_t TICK_MS = 10;
+    static const uint32_t MAX_PERIOD = 64UL * 64 * 64 * TICK_MS - TICK_MS;
+
+private:
+    static const uint8_t LEVELS = 3;
+    static const uint8_t SLOT_BITS = 6;
+    static const uint8_t SLOTS = 1 << SLOT_BITS;
+
+    struct Timer {
+        TimerCallback callback;
+        void* context;
+        uint32_t period;   // Ticks
+        uint32_t expires;  // Tick the timer fires on
+        int8_t next;       // Next timer in the same slot, -1 at the end
+        bool used;
+    };
+
+    Timer timers[MAX_TIMERS];
+    int8_t slots[LEVELS][SLOTS];  // Head of each slot's list, -1 when empty
+    uint32_t currentTick;
+    uint32_t lastMs;              // millis() value currentTick corresponds to
+
+    void insert(int8_t id);
+    void unlink(int8_t id);
+    void cascade(uint8_t level);
+    void tick();
+
+public:
+    TimerWheel();
+
+    void begin(uint32_t now);
+
+    // Returns the timer id, or -1 when full or the period is out of range
+    int add(uint32_t periodMs, TimerCallback callback, void* context = nullptr);
+    // Restarts the timer's period from now, e.g. after it ran early on request
+    void restart(int id);
+
+    // Runs every callback that came due up to now
+    void advance(uint32_t now);
+    // Milliseconds until the next timer is due, UINT32_MAX when none is armed
+    uint32_t msUntilNext(uint32_t now) const;
+    size_t size() const;
+};
+
+#endif // TIMER_WHEEL_H
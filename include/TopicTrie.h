@@ -0,0 +1,62 @@
+#ifndef TOPIC_TRIE_H
+#define TOPIC_TRIE_H
+
+#include <Arduino.h>
+
+typedef void (*MQTTMessageCallback)(const char* topic, const uint8_t* payload, unsigned int length);
+
+// Subscription filters stored as a trie of topic levels, so an incoming
+// topic is resolved in time proportional to its depth. Supports the MQTT
+// '+' (one level) and '#' (remaining levels) wildcards. Nodes reference
+// their level text inside the stored filter strings; nothing is allocated.
+class TopicTrie {
+public:
+    static const size_t MAX_FILTERS = 8;
+    static const size_t MAX_FILTER_LENGTH = 64;
+    static const size_t MAX_NODES = 48;
+
+private:
+    struct Filter {
+        char topic[MAX_FILTER_LENGTH];
+        MQTTMessageCallback handler;
+    };
+
+    struct Node {
+        uint8_t owner;   // Filter whose text holds this level
+        uint8_t offset;  // Start of the level inside that filter
+        uint8_t length;
+        int8_t filter;   // Filter ending at this node, -1 if none
+        int16_t child;   // First child, -1 if none
+        int16_t sibling; // Next node on the same level, -1 if none
+    };
+
+    Filter filters[MAX_FILTERS];
+    size_t filterCount;
+    Node nodes[MAX_NODES];  // nodes[0] is the root
+    size_t nodeCount;
+
+    static_assert(MAX_FILTERS <= 32, "Matches are collected in a 32-bit mask");
+
+    static bool isValid(const char* filter);
+    const char* levelText(const Node& node) const { return filters[node.owner].topic + node.offset; }
+    int16_t findChild(int16_t parent, const char* level, size_t length) const;
+    static void collect(int8_t filter, uint32_t& matches);
+    void matchNode(int16_t index, const char* level, uint32_t& matches) const;
+
+public:
+    TopicTrie();
+
+    // Adding a filter that already exists replaces its handler
+    bool add(const char* filter, MQTTMessageCallback handler);
+    void clear();
+
+    // Calls each distinct handler of the matching filters once, so a topic
+    // covered by two filters (say the command topic and "broadcast/#") with
+    // the same handler is not handled twice; returns how many filters matched
+    size_t dispatch(const char* topic, const uint8_t* payload, unsigned int length) const;
+
+    size_t size() const { return filterCount; }
+    const char* getFilter(size_t index) const { return filters[index].topic; }
+};
+
+#endif // TOPIC_TRIE_H
@@ -0,0 +1,61 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+
+#define TRACE_CAPACITY 128  // Records per core, power of two
+
+// Trace point ids; names for the dump are in Trace.cpp
+enum TracePoint : uint16_t {
+    TRACE_BOOT,
+    TRACE_NETWORK_UPDATE,
+    TRACE_MQTT_UPDATE,
+    TRACE_TELEMETRY_PUBLISH,
+    TRACE_JOBS,
+    TRACE_NETWORK_WAIT,
+    TRACE_DHT_READ,
+    TRACE_SENSOR_LOG,
+    TRACE_SENSOR_FORMAT,
+    TRACE_COMMAND,
+    TRACE_POINT_COUNT
+};
+
+enum TracePhase : uint8_t {
+    TRACE_PHASE_BEGIN = 'B',
+    TRACE_PHASE_END = 'E',
+    TRACE_PHASE_INSTANT = 'i'
+};
+
+// Begin/end records stamped with the CPU cycle counter, kept in one ring per
+// core in RTC memory so the last moments before a watchdog or panic reset can
+// be read back after reboot. Recording masks interrupts on the local core
+// for a few instructions and never takes a lock.
+// Cycle counts convert to time only while the CPU clock is fixed, so use the
+// "performance" power mode when timing matters.
+// Build with -DTRACE_DISABLED to turn every trace point into a no-op.
+class Trace {
+public:
+    static void begin();
+    static void record(uint16_t id, uint8_t phase);
+
+    // Writes "# " header lines, then "core,cycles,id,phase" rows oldest first.
+    // Pause recording around dumpLength() and dump() when the two must agree.
+    static size_t dump(Print& out);
+    static size_t dumpLength();
+    static void pause(bool paused);
+
+    // The preserved buffer came from a boot that ended abnormally
+    static bool hasCrashTrace();
+};
+
+// Records begin on construction and end when the scope closes
+class TraceScope {
+private:
+    uint16_t id;
+
+public:
+    explicit TraceScope(uint16_t id) : id(id) { Trace::record(id, TRACE_PHASE_BEGIN); }
+    ~TraceScope() { Trace::record(id, TRACE_PHASE_END); }
+};
+
+#endif // TRACE_H
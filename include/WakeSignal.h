@@ -0,0 +1,27 @@
+#ifndef WAKE_SIGNAL_H
+#define WAKE_SIGNAL_H
+
+#include <Arduino.h>
+
+// Blocks the network task until its MQTT socket has data, another task has
+// work for it, or a timeout passes. lwIP sockets can only be waited on with
+// select(), so the wakeup is an eventfd in the same select() set rather than
+// a task notification.
+class WakeSignal {
+private:
+    int fd;
+
+public:
+    WakeSignal();
+
+    bool begin();
+
+    // Safe from any task, not from an ISR
+    void notify();
+
+    // Returns true if woken by the socket or notify(), false on timeout.
+    // socket may be -1 to wait on notify() alone.
+    bool wait(int socket, uint32_t timeoutMs);
+};
+
+#endif // WAKE_SIGNAL_H
@@ -2,11 +2,12 @@
 #define WIFI_MODULE_H
 
 #include <WiFi.h>
+#include "FixedString.h"
 
 class WiFiModule {
 private:
-    String ssid;
-    String password;
+    SSIDString ssid;
+    PassphraseString password;
     bool connected;
     bool connecting;
     bool useStaticIP;
@@ -18,7 +19,7 @@ private:
 
 public:
     WiFiModule();
-    void setCredentials(const String& ssid, const String& password);
+    bool setCredentials(const char* ssid, const char* password);
     void setStaticIP(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2);
     void enableStaticIP(bool enable);
     bool connect();
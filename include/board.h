@@ -4,6 +4,17 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+// Network hardware fitted to this board. WiFi is the ESP32's own radio and
+// always present; a 0 here leaves the interface's module, its driver and
+// its bookkeeping out of the firmware. Board profiles in platformio.ini
+// override these with -D flags.
+#ifndef BOARD_HAS_ETHERNET
+#define BOARD_HAS_ETHERNET  1   // W5500 on SPI
+#endif
+#ifndef BOARD_HAS_LTE
+#define BOARD_HAS_LTE       0   // SIM7600 over PPP
+#endif
+
 // Ethernet SPI pins for W5500
 #define ETHERNET_SCK_PIN   25
 #define ETHERNET_MISO_PIN  23
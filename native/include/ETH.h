@@ -0,0 +1,32 @@
+#ifndef ETH_H
+#define ETH_H
+
+#include "Network.h"
+#include "SPI.h"
+
+typedef enum {
+    ETH_PHY_LAN8720,
+    ETH_PHY_TLK110,
+    ETH_PHY_RTL8201,
+    ETH_PHY_DP83848,
+    ETH_PHY_KSZ8041,
+    ETH_PHY_KSZ8081,
+    ETH_PHY_W5500,
+    ETH_PHY_DM9051,
+    ETH_PHY_KSZ8851
+} eth_phy_type_t;
+
+// The cable is the link; an address follows after the bring-up time (DHCP)
+class ETHClass : public FakeLink {
+public:
+    ETHClass() : FakeLink("Ethernet", IPAddress(192, 168, 1, 60), ARDUINO_EVENT_ETH_CONNECTED, ARDUINO_EVENT_ETH_DISCONNECTED) {}
+
+    bool begin(eth_phy_type_t type, int32_t phyAddr, int cs, int irq, int rst, SPIClass& spi, uint8_t spiFreqMhz = 20);
+    bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress()) { return true; }
+    bool linkUp() { return isStarted() && isAvailable(); }
+    bool hasIP() { return isUp(); }
+};
+
+extern ETHClass ETH;
+
+#endif // ETH_H
@@ -0,0 +1,62 @@
+#ifndef FS_H
+#define FS_H
+
+#include <memory>
+#include <time.h>
+#include "Stream.h"
+
+namespace fs {
+
+struct FileImpl;
+
+// Same shape as the core's fs::File: copies share one open handle
+class File : public Stream {
+private:
+    std::shared_ptr<FileImpl> impl;
+
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t* buffer, size_t size);
+    size_t readBytes(char* buffer, size_t length) override { return read((uint8_t*)buffer, length); }
+    void flush() override;
+
+    bool seek(uint32_t position);
+    size_t position() const;
+    size_t size() const;
+    time_t getLastWrite();
+    const char* path() const;
+    const char* name() const;
+    bool isDirectory() const;
+    File openNextFile(const char* mode = "r");
+    void close();
+    operator bool() const;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = "r", bool create = false);
+    File open(const String& path, const char* mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+    bool rmdir(const char* path);
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // FS_H
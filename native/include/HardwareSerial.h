@@ -0,0 +1,33 @@
+#ifndef HARDWARE_SERIAL_H
+#define HARDWARE_SERIAL_H
+
+#include "Stream.h"
+
+#define SERIAL_8N1 0x800001c
+
+// Serial writes to stdout; other ports discard output and never receive.
+// Output is dropped between end() and the next begin(), as on the board.
+class HardwareSerial : public Stream {
+private:
+    int port;
+    bool open;
+
+public:
+    explicit HardwareSerial(int port) : port(port), open(true) {}
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1) { open = true; }
+    void end() { open = false; }
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override;
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // HARDWARE_SERIAL_H
@@ -0,0 +1,85 @@
+#ifndef HOST_BROKER_H
+#define HOST_BROKER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "Network.h"
+#include "mbedtls/ssl.h"
+
+// Byte streams between one NetworkClientSecure and the broker
+struct HostConnection {
+    FakeLink* link;          // Default route when the connection was opened
+    bool open;
+    bool sessionStarted;     // CONNECT accepted
+    std::string toClient;
+    std::string fromClient;  // Partial packet still being received
+    std::vector<std::string> filters;
+};
+
+struct BrokerMessage {
+    std::string topic;
+    std::string payload;
+    uint8_t qos;
+    unsigned long receivedAt;
+};
+
+// In-process MQTT 3.1.1 broker stand-in. It parses the real packets
+// PubSubClient and MQTTModule write and answers synchronously, so every
+// run is repeatable. Failures are scripted with the setters below.
+class HostBroker {
+private:
+    std::vector<std::shared_ptr<HostConnection>> connections;
+    std::vector<BrokerMessage> received;
+    std::vector<std::string> tlsSessions;  // Session IDs the broker would resume
+    IPAddress address;
+    uint16_t port;
+    bool online;
+    bool acceptConnect;
+    bool ackPublishes;
+    bool resumeSessions;
+    bool failHandshakes;
+    uint32_t connects;
+    uint32_t refused;
+
+    void handle(HostConnection& connection, uint8_t type, uint8_t flags, const uint8_t* body, size_t length);
+    void deliver(const std::string& topic, const std::string& payload);
+    static void send(HostConnection& connection, uint8_t header, const uint8_t* body, size_t length);
+
+public:
+    HostBroker();
+
+    // Registers the name the firmware resolves, e.g. the broker in config.json
+    void listen(const char* host, uint16_t port, IPAddress address = IPAddress(10, 0, 0, 1));
+
+    // Scripting
+    void setOnline(bool online);                 // Offline refuses TCP and drops every connection
+    void setAcceptConnect(bool accept) { acceptConnect = accept; }  // CONNACK "not authorized" when false
+    void setAckPublishes(bool ack) { ackPublishes = ack; }          // Withhold PUBACKs when false
+    void setResumeSessions(bool resume) { resumeSessions = resume; }
+    void setFailHandshakes(bool fail) { failHandshakes = fail; }
+    void dropConnections();
+    // Sends to every connection with a matching subscription
+    void publish(const char* topic, const char* payload);
+
+    // Inspection
+    const std::vector<BrokerMessage>& getReceived() const { return received; }
+    size_t countReceived(const char* topic) const;
+    void clearReceived() { received.clear(); }
+    uint32_t getConnects() const { return connects; }
+    uint32_t getRefused() const { return refused; }
+    size_t getOpenConnections() const;
+    bool isSubscribed(const char* topic) const;
+
+    // Transport, used by the NetworkClientSecure and mbedTLS stand-ins
+    std::shared_ptr<HostConnection> open(IPAddress address, uint16_t port);
+    void receive(HostConnection& connection, const uint8_t* data, size_t length);
+    bool handshake(const mbedtls_ssl_session& offered, mbedtls_ssl_session& session);
+
+    static bool matches(const char* filter, const char* topic);
+};
+
+extern HostBroker Broker;
+
+#endif // HOST_BROKER_H
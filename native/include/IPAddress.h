@@ -0,0 +1,33 @@
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+#include <stdint.h>
+#include <netinet/in.h>
+#include "WString.h"
+
+// IPv4 only; the uint32_t form holds the bytes in network order like lwIP
+class IPAddress {
+private:
+    uint8_t bytes[4];
+
+public:
+    IPAddress() : bytes{ 0, 0, 0, 0 } {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{ a, b, c, d } {}
+    IPAddress(uint32_t address);
+    explicit IPAddress(const uint8_t* address) : bytes{ address[0], address[1], address[2], address[3] } {}
+
+    operator uint32_t() const;
+    uint8_t operator[](int index) const { return bytes[index]; }
+    bool operator==(const IPAddress& other) const { return (uint32_t)*this == (uint32_t)other; }
+    bool operator!=(const IPAddress& other) const { return !(*this == other); }
+
+    bool fromString(const char* address);
+    bool fromString(const String& address) { return fromString(address.c_str()); }
+    String toString() const;
+};
+
+// The core's INADDR_NONE is an IPAddress, not the socket API's macro
+#undef INADDR_NONE
+extern const IPAddress INADDR_NONE;
+
+#endif // IPADDRESS_H
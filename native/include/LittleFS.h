@@ -0,0 +1,27 @@
+#ifndef LITTLEFS_H
+#define LITTLEFS_H
+
+#include "FS.h"
+
+// LittleFS on a host directory. Paths map onto the root directory, which
+// begin() creates when formatOnFail is set, like formatting an empty partition.
+class LittleFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+    void end() {}
+    bool format();
+    size_t totalBytes();
+    size_t usedBytes();
+
+    // Host only; the default is ./data, the same files uploadfs puts on the board
+    void setRoot(const char* directory);
+    const char* getRoot() const;
+    // Host only: roots the filesystem in a fresh scratch copy of directory's
+    // files, so writes never reach the original; removeCopy() deletes it
+    bool mountCopy(const char* directory);
+    void removeCopy();
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // LITTLEFS_H
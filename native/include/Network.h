@@ -0,0 +1,79 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <Arduino.h>
+#include "esp_netif.h"
+
+typedef enum {
+    ARDUINO_EVENT_NONE,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+    ARDUINO_EVENT_ETH_CONNECTED,
+    ARDUINO_EVENT_ETH_DISCONNECTED,
+    ARDUINO_EVENT_PPP_CONNECTED,
+    ARDUINO_EVENT_PPP_DISCONNECTED
+} arduino_event_id_t;
+
+typedef union {
+    int reserved;
+} arduino_event_info_t;
+
+typedef void (*NetworkEventCb)(arduino_event_id_t event, arduino_event_info_t info);
+
+// One scripted interface behind the WiFi, ETH and PPP stand-ins. A started
+// link is up once it has been available for its bring-up time, and comes
+// back on its own after an outage like the real drivers do.
+class FakeLink {
+private:
+    const char* name;
+    esp_netif_t handle;
+    arduino_event_id_t upEvent;
+    arduino_event_id_t downEvent;
+    IPAddress address;
+    bool available;
+    bool started;
+    unsigned long bringUpTime;
+    unsigned long upAt;
+    int signal;
+
+    static FakeLink* defaultLink;
+
+public:
+    FakeLink(const char* name, IPAddress address, arduino_event_id_t upEvent, arduino_event_id_t downEvent);
+
+    // Scripting: AP in range, cable plugged in, LTE coverage
+    void setAvailable(bool available);
+    void setBringUpTime(unsigned long ms) { bringUpTime = ms; }
+    void setSignal(int dBm) { signal = dBm; }
+    bool isAvailable() const { return available; }
+
+    // Driver side
+    void start();
+    void stop();
+    bool isStarted() const { return started; }
+    bool isUp() const;
+    int getSignal() const { return isUp() ? signal : 0; }
+    IPAddress localIP() const { return isUp() ? address : IPAddress(); }
+    const char* getName() const { return name; }
+
+    bool setDefault();
+    esp_netif_t* netif() { return &handle; }
+    static FakeLink* getDefault() { return defaultLink; }
+};
+
+class NetworkClass {
+public:
+    int hostByName(const char* host, IPAddress& result);
+    bool macAddress(uint8_t* mac);
+    void onEvent(NetworkEventCb callback);
+
+    // Host only: names the DNS stand-ins resolve
+    void addHost(const char* host, IPAddress address);
+    bool lookupHost(const char* host, IPAddress& result) const;
+
+    void raise(arduino_event_id_t event);
+};
+
+extern NetworkClass Network;
+
+#endif // NETWORK_H
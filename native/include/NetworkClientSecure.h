@@ -0,0 +1,63 @@
+#ifndef NETWORK_CLIENT_SECURE_H
+#define NETWORK_CLIENT_SECURE_H
+
+#include <memory>
+#include <Client.h>
+#include "Network.h"
+#include "mbedtls/ssl.h"
+
+struct sslclient_context {
+    int socket = -1;  // Never opened; the connection is in-process
+    mbedtls_ssl_context ssl_ctx;
+};
+
+struct HostConnection;
+
+// Connects to the in-process broker (HostBroker.h) over the current default
+// link instead of a socket. The connection breaks when that link goes down.
+class NetworkClientSecure : public Client {
+protected:
+    std::shared_ptr<sslclient_context> sslclient;
+    std::shared_ptr<HostConnection> connection;
+    const char* _CA_cert;
+    const char* _cert;
+    const char* _private_key;
+    unsigned long _handshake_timeout;
+    unsigned long _timeout;
+    bool _stillinPlainStart;
+    bool _use_insecure;
+
+public:
+    NetworkClientSecure();
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(IPAddress ip, uint16_t port, const char* host, const char* rootCA, const char* clientCert, const char* clientKey);
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+
+    void setCACert(const char* rootCA) { _CA_cert = rootCA; }
+    void setCertificate(const char* clientCert) { _cert = clientCert; }
+    void setPrivateKey(const char* privateKey) { _private_key = privateKey; }
+    void setInsecure() { _use_insecure = true; }
+    void setConnectionTimeout(uint32_t timeout) { _timeout = timeout; }
+    void setHandshakeTimeout(unsigned long timeout) { _handshake_timeout = timeout * 1000; }
+    // Open the connection without handshaking; the caller drives mbedTLS
+    void setPlainStart() { _stillinPlainStart = true; }
+    bool stillInPlainStart() const { return _stillinPlainStart; }
+
+    // No host socket backs the connection
+    int fd() const { return -1; }
+};
+
+#endif // NETWORK_CLIENT_SECURE_H
@@ -0,0 +1,48 @@
+#ifndef PPP_H
+#define PPP_H
+
+#include "Network.h"
+
+typedef enum {
+    PPP_MODEM_GENERIC,
+    PPP_MODEM_SIM7600,
+    PPP_MODEM_SIM7070,
+    PPP_MODEM_SIM7000,
+    PPP_MODEM_BG96,
+    PPP_MODEM_SIM800
+} ppp_modem_model_t;
+
+typedef enum {
+    ESP_MODEM_FLOW_CONTROL_NONE,
+    ESP_MODEM_FLOW_CONTROL_SW,
+    ESP_MODEM_FLOW_CONTROL_HW
+} esp_modem_flow_ctrl_t;
+
+typedef enum {
+    ESP_MODEM_MODE_COMMAND,
+    ESP_MODEM_MODE_DATA,
+    ESP_MODEM_MODE_CMUX
+} esp_modem_dce_mode_t;
+
+// Coverage is the link; the data session follows after the bring-up time
+class PPPClass : public FakeLink {
+public:
+    PPPClass() : FakeLink("LTE", IPAddress(10, 64, 0, 2), ARDUINO_EVENT_PPP_CONNECTED, ARDUINO_EVENT_PPP_DISCONNECTED) {}
+
+    void setApn(const char* apn) {}
+    void setPin(const char* pin) {}
+    void setResetPin(int8_t rst, bool activeLow = true, uint32_t delay = 200) {}
+    bool setPins(int8_t tx, int8_t rx, int8_t rts = -1, int8_t cts = -1, esp_modem_flow_ctrl_t flowControl = ESP_MODEM_FLOW_CONTROL_NONE) { return true; }
+    bool begin(ppp_modem_model_t model, uint8_t uart = 1, int baud = 115200);
+    bool attached() { return isStarted() && isAvailable(); }
+    bool mode(esp_modem_dce_mode_t mode) { return attached(); }
+    // Lets simulated time pass until the session is up or the timeout expires
+    int waitStatusBits(int bits, uint32_t timeout);
+    bool connected() { return isUp(); }
+    // CSQ 0-31, 99 when unknown
+    int RSSI();
+};
+
+extern PPPClass PPP;
+
+#endif // PPP_H
@@ -0,0 +1,14 @@
+#ifndef SPI_H
+#define SPI_H
+
+#include <stdint.h>
+
+class SPIClass {
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void end() {}
+};
+
+extern SPIClass SPI;
+
+#endif // SPI_H
@@ -0,0 +1,65 @@
+#ifndef WSTRING_H
+#define WSTRING_H
+
+#include <stddef.h>
+#include <string>
+
+// Heap-backed like the core's String, so allocation counts stay comparable
+class String {
+private:
+    std::string value;
+
+public:
+    String() {}
+    String(const char* str) : value(str ? str : "") {}
+    String(const String& other) : value(other.value) {}
+    explicit String(char c) : value(1, c) {}
+    explicit String(int n, unsigned char base = 10);
+    explicit String(unsigned int n, unsigned char base = 10);
+    explicit String(long n, unsigned char base = 10);
+    explicit String(unsigned long n, unsigned char base = 10);
+    explicit String(float n, unsigned int decimals = 2);
+    explicit String(double n, unsigned int decimals = 2);
+
+    String& operator=(const String& other) { value = other.value; return *this; }
+    String& operator=(const char* str) { value = str ? str : ""; return *this; }
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.length(); }
+    bool isEmpty() const { return value.empty(); }
+    void reserve(unsigned int size) { value.reserve(size); }
+    char charAt(unsigned int index) const { return index < value.length() ? value[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    bool concat(const String& other) { value += other.value; return true; }
+    bool concat(const char* str) { if (str) value += str; return str != nullptr; }
+    bool concat(const char* str, unsigned int length) { if (str) value.append(str, length); return str != nullptr; }
+    bool concat(char c) { value += c; return true; }
+    String& operator+=(const String& other) { concat(other); return *this; }
+    String& operator+=(const char* str) { concat(str); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+
+    bool equals(const String& other) const { return value == other.value; }
+    bool equals(const char* str) const { return value == (str ? str : ""); }
+    bool operator==(const String& other) const { return equals(other); }
+    bool operator==(const char* str) const { return equals(str); }
+    bool operator!=(const String& other) const { return !equals(other); }
+    bool operator!=(const char* str) const { return !equals(str); }
+    bool operator<(const String& other) const { return value < other.value; }
+
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.length(), prefix.value) == 0; }
+    bool endsWith(const String& suffix) const;
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& str, unsigned int from = 0) const;
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const;
+    void trim();
+    long toInt() const { return atol(value.c_str()); }
+    float toFloat() const { return (float)atof(value.c_str()); }
+};
+
+String operator+(const String& left, const String& right);
+String operator+(const String& left, const char* right);
+String operator+(const char* left, const String& right);
+
+#endif // WSTRING_H
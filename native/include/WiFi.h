@@ -0,0 +1,43 @@
+#ifndef WIFI_H
+#define WIFI_H
+
+#include "Network.h"
+#include "esp_wifi.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class STAClass : public FakeLink {
+public:
+    STAClass() : FakeLink("WiFi", IPAddress(192, 168, 1, 50), ARDUINO_EVENT_WIFI_STA_CONNECTED, ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {}
+};
+
+class WiFiClass {
+private:
+    wifi_ps_type_t sleepMode;
+
+public:
+    STAClass STA;
+
+    WiFiClass() : sleepMode(WIFI_PS_MIN_MODEM) {}
+
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr);
+    bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+    bool disconnect(bool wifiOff = false, bool eraseAP = false);
+    wl_status_t status();
+    IPAddress localIP() { return STA.localIP(); }
+    int8_t RSSI() { return STA.getSignal(); }
+    bool setSleep(wifi_ps_type_t mode) { sleepMode = mode; return true; }
+    wifi_ps_type_t getSleep() const { return sleepMode; }
+    void onEvent(NetworkEventCb callback) { Network.onEvent(callback); }
+};
+
+extern WiFiClass WiFi;
+
+#endif // WIFI_H
@@ -0,0 +1,18 @@
+#ifndef ESP_NETIF_H
+#define ESP_NETIF_H
+
+#include "esp_err.h"
+
+// Handle for one fake link; see Network.h
+struct esp_netif_obj {
+    const char* name;
+};
+typedef struct esp_netif_obj esp_netif_t;
+
+#define ESP_NETIF_CONNECTED_BIT (1 << 0)
+
+// Fake links have no host interface to bind a socket to, so this always
+// fails and NetworkController skips its TCP reachability probes
+esp_err_t esp_netif_get_netif_impl_name(esp_netif_t* netif, char* name);
+
+#endif // ESP_NETIF_H
@@ -0,0 +1,16 @@
+#ifndef ESP_PM_H
+#define ESP_PM_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef struct {
+    int max_freq_mhz;
+    int min_freq_mhz;
+    bool light_sleep_enable;
+} esp_pm_config_t;
+
+// Behaves like a core built without power management: always ESP_ERR_NOT_SUPPORTED
+esp_err_t esp_pm_configure(const void* config);
+
+#endif // ESP_PM_H
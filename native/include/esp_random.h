@@ -0,0 +1,10 @@
+#ifndef ESP_RANDOM_H
+#define ESP_RANDOM_H
+
+#include <stdint.h>
+
+// Deterministic sequence; reseed with hostSeedRandom() to vary a run
+uint32_t esp_random();
+void hostSeedRandom(uint32_t seed);
+
+#endif // ESP_RANDOM_H
@@ -0,0 +1,11 @@
+#ifndef LWIP_DNS_H
+#define LWIP_DNS_H
+
+#include "lwip/ip_addr.h"
+
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* address, void* arg);
+
+// Answers from the Network.addHost() table straight away; unknown names fail
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* address, dns_found_callback found, void* arg);
+
+#endif // LWIP_DNS_H
@@ -0,0 +1,33 @@
+#ifndef LWIP_IP_ADDR_H
+#define LWIP_IP_ADDR_H
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+
+#define ERR_OK          0
+#define ERR_MEM         -1
+#define ERR_INPROGRESS  -5
+#define ERR_VAL         -6
+#define ERR_ARG         -16
+
+#define IPADDR_TYPE_V4  0
+#define IPADDR_TYPE_V6  6
+
+typedef struct {
+    uint32_t addr;
+} ip4_addr_t;
+
+typedef struct {
+    union {
+        ip4_addr_t ip4;
+        uint32_t ip6[4];
+    } u_addr;
+    uint8_t type;
+} ip_addr_t;
+
+#define IP_IS_V4(address)           ((address)->type == IPADDR_TYPE_V4)
+#define ip_2_ip4(address)           (&((address)->u_addr.ip4))
+#define ip4_addr_get_u32(address)   ((address)->addr)
+
+#endif // LWIP_IP_ADDR_H
@@ -0,0 +1,11 @@
+#ifndef LWIP_TCPIP_H
+#define LWIP_TCPIP_H
+
+#include "lwip/ip_addr.h"
+
+typedef void (*tcpip_callback_fn)(void* context);
+
+// There is no lwIP thread on the host; the function runs on the caller
+err_t tcpip_callback(tcpip_callback_fn function, void* context);
+
+#endif // LWIP_TCPIP_H
@@ -0,0 +1,37 @@
+#ifndef MBEDTLS_SSL_H
+#define MBEDTLS_SSL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Just enough of mbedTLS for SecureSessionClient: a handshake that takes a
+// fixed number of steps and session IDs the broker stand-in may resume.
+// Nothing is encrypted.
+
+#define MBEDTLS_PRIVATE(member) member  // Fields are private in mbedTLS 3
+
+#define MBEDTLS_ERR_SSL_WANT_READ           -0x6900
+#define MBEDTLS_ERR_SSL_WANT_WRITE          -0x6880
+#define MBEDTLS_ERR_SSL_HANDSHAKE_FAILURE   -0x7180
+
+typedef struct {
+    size_t id_len;
+    unsigned char id[32];
+} mbedtls_ssl_session;
+
+typedef struct {
+    int step;                   // Handshake round trips taken
+    bool done;
+    mbedtls_ssl_session offered;
+    mbedtls_ssl_session session;
+} mbedtls_ssl_context;
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session* session);
+void mbedtls_ssl_session_free(mbedtls_ssl_session* session);
+void mbedtls_ssl_init(mbedtls_ssl_context* ssl);
+int mbedtls_ssl_get_session(const mbedtls_ssl_context* ssl, mbedtls_ssl_session* session);
+int mbedtls_ssl_set_session(mbedtls_ssl_context* ssl, const mbedtls_ssl_session* session);
+int mbedtls_ssl_handshake_step(mbedtls_ssl_context* ssl);
+int mbedtls_ssl_is_handshake_over(mbedtls_ssl_context* ssl);
+
+#endif // MBEDTLS_SSL_H
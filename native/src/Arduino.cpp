@@ -0,0 +1,119 @@
+#include <Arduino.h>
+#include <esp_random.h>
+#include <esp_pm.h>
+#include <unistd.h>
+
+static uint64_t clockMicros = 0;
+static uint32_t cpuMhz = 240;
+static uint32_t randomState = 0x2545F491;
+
+HardwareSerial Serial(0);
+EspClass ESP;
+
+unsigned long millis() {
+    return (unsigned long)(clockMicros / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)clockMicros;
+}
+
+void hostAdvance(unsigned long ms) {
+    clockMicros += (uint64_t)ms * 1000;
+}
+
+void hostAdvanceMicros(unsigned long us) {
+    clockMicros += us;
+}
+
+void delay(unsigned long ms) {
+    hostAdvance(ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+    hostAdvanceMicros(us);
+}
+
+void yield() {
+}
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dest, const char* src, size_t size) {
+    size_t length = strlen(src);
+    if (size > 0) {
+        size_t count = length < size - 1 ? length : size - 1;
+        memcpy(dest, src, count);
+        dest[count] = '\0';
+    }
+    return length;
+}
+
+size_t strlcat(char* dest, const char* src, size_t size) {
+    size_t used = strnlen(dest, size);
+    if (used == size) return size + strlen(src);
+    return used + strlcpy(dest + used, src, size - used);
+}
+#endif
+
+uint32_t esp_random() {
+    // xorshift32, same generator as Backoff
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+void hostSeedRandom(uint32_t seed) {
+    randomState = seed ? seed : 1;
+}
+
+long random(long max) {
+    return max > 0 ? (long)(esp_random() % (uint32_t)max) : 0;
+}
+
+long random(long min, long max) {
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    hostSeedRandom((uint32_t)seed);
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return cpuMhz;
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+    cpuMhz = mhz;
+    return true;
+}
+
+esp_err_t esp_pm_configure(const void* config) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+// The host heap is not the device heap; report the ESP32's usable DRAM so
+// callers that subtract two readings see no change
+uint32_t EspClass::getFreeHeap() { return 300 * 1024; }
+uint32_t EspClass::getHeapSize() { return 320 * 1024; }
+uint32_t EspClass::getMinFreeHeap() { return 300 * 1024; }
+uint32_t EspClass::getMaxAllocHeap() { return 110 * 1024; }
+
+void EspClass::restart() {
+    Serial.println("ESP.restart() called on the host, exiting");
+    Serial.flush();
+    exit(0);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (port != 0 || !open) return size;
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    if (port == 0) fflush(stdout);
+}
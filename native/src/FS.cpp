@@ -0,0 +1,275 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+
+LittleFSFS LittleFS;
+
+static std::string root = "data";
+static std::string scratch;  // Set while mountCopy() owns the root
+static bool mounted = false;
+
+namespace fs {
+
+struct FileImpl {
+    std::string path;      // As the firmware sees it, e.g. /outbox/head
+    std::string hostPath;
+    FILE* file;
+    DIR* dir;
+
+    FileImpl() : file(nullptr), dir(nullptr) {}
+    ~FileImpl() {
+        if (file) fclose(file);
+        if (dir) closedir(dir);
+    }
+};
+
+static std::string hostPathFor(const char* path) {
+    std::string result = root;
+    if (path[0] != '/') result += '/';
+    result += path;
+    return result;
+}
+
+static File openImpl(const char* path, const char* mode) {
+    std::shared_ptr<FileImpl> impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    impl->hostPath = hostPathFor(path);
+
+    struct stat info;
+    bool exists = stat(impl->hostPath.c_str(), &info) == 0;
+    if (exists && S_ISDIR(info.st_mode)) {
+        impl->dir = opendir(impl->hostPath.c_str());
+        return impl->dir ? File(impl) : File();
+    }
+
+    const char* hostMode = "rb";
+    if (strcmp(mode, "w") == 0) hostMode = "wb";
+    else if (strcmp(mode, "a") == 0) hostMode = "ab";
+    else if (strcmp(mode, "r+") == 0) hostMode = "r+b";
+    else if (strcmp(mode, "w+") == 0) hostMode = "w+b";
+    else if (strcmp(mode, "a+") == 0) hostMode = "a+b";
+    impl->file = fopen(impl->hostPath.c_str(), hostMode);
+    return impl->file ? File(impl) : File();
+}
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!impl || !impl->file) return 0;
+    return fwrite(buffer, 1, size, impl->file);
+}
+
+int File::available() {
+    if (!impl || !impl->file) return 0;
+    return (int)(size() - position());
+}
+
+int File::read() {
+    if (!impl || !impl->file) return -1;
+    int c = fgetc(impl->file);
+    return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+    if (!impl || !impl->file) return -1;
+    int c = fgetc(impl->file);
+    if (c == EOF) return -1;
+    ungetc(c, impl->file);
+    return c;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (!impl || !impl->file) return 0;
+    return fread(buffer, 1, size, impl->file);
+}
+
+void File::flush() {
+    if (impl && impl->file) fflush(impl->file);
+}
+
+bool File::seek(uint32_t position) {
+    return impl && impl->file && fseek(impl->file, position, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+    if (!impl || !impl->file) return 0;
+    long position = ftell(impl->file);
+    return position < 0 ? 0 : (size_t)position;
+}
+
+size_t File::size() const {
+    if (!impl || !impl->file) return 0;
+    fflush(impl->file);
+    struct stat info;
+    return fstat(fileno(impl->file), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+time_t File::getLastWrite() {
+    if (!impl) return 0;
+    struct stat info;
+    return stat(impl->hostPath.c_str(), &info) == 0 ? info.st_mtime : 0;
+}
+
+const char* File::path() const {
+    return impl ? impl->path.c_str() : nullptr;
+}
+
+const char* File::name() const {
+    if (!impl) return nullptr;
+    const char* slash = strrchr(impl->path.c_str(), '/');
+    return slash ? slash + 1 : impl->path.c_str();
+}
+
+bool File::isDirectory() const {
+    return impl && impl->dir;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!impl || !impl->dir) return File();
+    while (struct dirent* entry = readdir(impl->dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        std::string child = impl->path;
+        if (child.empty() || child.back() != '/') child += '/';
+        child += entry->d_name;
+        return openImpl(child.c_str(), mode);
+    }
+    return File();
+}
+
+void File::close() {
+    impl.reset();
+}
+
+File::operator bool() const {
+    return impl && (impl->file || impl->dir);
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+    if (!mounted) return File();
+    return openImpl(path, mode);
+}
+
+bool FS::exists(const char* path) {
+    struct stat info;
+    return mounted && stat(hostPathFor(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return mounted && unlink(hostPathFor(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return mounted && ::rename(hostPathFor(from).c_str(), hostPathFor(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return mounted && ::mkdir(hostPathFor(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path) {
+    return mounted && ::rmdir(hostPathFor(path).c_str()) == 0;
+}
+
+}  // namespace fs
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    struct stat info;
+    if (stat(root.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+        mounted = true;
+    } else if (formatOnFail) {
+        mounted = ::mkdir(root.c_str(), 0755) == 0;
+    }
+    return mounted;
+}
+
+bool LittleFSFS::format() {
+    // Never deletes host files; an empty directory is what a fresh partition looks like
+    return begin(true);
+}
+
+size_t LittleFSFS::totalBytes() {
+    return 1536 * 1024;  // Default partition table's LittleFS size
+}
+
+size_t LittleFSFS::usedBytes() {
+    return 0;
+}
+
+void LittleFSFS::setRoot(const char* directory) {
+    root = directory;
+    mounted = false;
+}
+
+const char* LittleFSFS::getRoot() const {
+    return root.c_str();
+}
+
+static bool copyFile(const std::string& from, const std::string& to) {
+    FILE* source = fopen(from.c_str(), "rb");
+    if (!source) return false;
+    FILE* dest = fopen(to.c_str(), "wb");
+    if (!dest) {
+        fclose(source);
+        return false;
+    }
+    char chunk[512];
+    size_t read;
+    bool ok = true;
+    while ((read = fread(chunk, 1, sizeof(chunk), source)) > 0) {
+        ok &= fwrite(chunk, 1, read, dest) == read;
+    }
+    fclose(source);
+    return fclose(dest) == 0 && ok;
+}
+
+bool LittleFSFS::mountCopy(const char* directory) {
+    removeCopy();
+    char path[] = "/tmp/esp32-littlefs-XXXXXX";
+    if (!mkdtemp(path)) {
+        Serial.printf("❌ Cannot create scratch directory: %s\n", strerror(errno));
+        return false;
+    }
+    scratch = path;
+
+    // An empty partition if the directory is missing, like a board that never had uploadfs
+    DIR* dir = opendir(directory);
+    if (dir) {
+        while (struct dirent* entry = readdir(dir)) {
+            std::string from = std::string(directory) + "/" + entry->d_name;
+            struct stat info;
+            if (stat(from.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) continue;
+            if (!copyFile(from, scratch + "/" + entry->d_name)) {
+                Serial.printf("❌ Cannot copy %s\n", from.c_str());
+            }
+        }
+        closedir(dir);
+    }
+    setRoot(scratch.c_str());
+    return true;
+}
+
+static void removeTree(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        unlink(path.c_str());
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        removeTree(path + "/" + entry->d_name);
+    }
+    closedir(dir);
+    ::rmdir(path.c_str());
+}
+
+void LittleFSFS::removeCopy() {
+    if (scratch.empty()) return;
+    removeTree(scratch);
+    scratch.clear();
+    mounted = false;
+}
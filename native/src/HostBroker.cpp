@@ -0,0 +1,268 @@
+#include "HostBroker.h"
+#include <algorithm>
+
+#define MQTT_CONNECT     1
+#define MQTT_CONNACK     2
+#define MQTT_PUBLISH     3
+#define MQTT_PUBACK      4
+#define MQTT_SUBSCRIBE   8
+#define MQTT_SUBACK      9
+#define MQTT_UNSUBSCRIBE 10
+#define MQTT_UNSUBACK    11
+#define MQTT_PINGREQ     12
+#define MQTT_PINGRESP    13
+#define MQTT_DISCONNECT  14
+
+#define CONNACK_NOT_AUTHORIZED 5
+
+HostBroker Broker;
+
+HostBroker::HostBroker() :
+    port(8883),
+    online(true),
+    acceptConnect(true),
+    ackPublishes(true),
+    resumeSessions(true),
+    failHandshakes(false),
+    connects(0),
+    refused(0)
+{
+}
+
+void HostBroker::listen(const char* host, uint16_t port, IPAddress address) {
+    this->address = address;
+    this->port = port;
+    Network.addHost(host, address);
+}
+
+void HostBroker::setOnline(bool online) {
+    this->online = online;
+    if (!online) dropConnections();
+}
+
+void HostBroker::dropConnections() {
+    for (std::shared_ptr<HostConnection>& connection : connections) {
+        connection->open = false;
+    }
+    connections.clear();
+}
+
+std::shared_ptr<HostConnection> HostBroker::open(IPAddress address, uint16_t port) {
+    FakeLink* link = FakeLink::getDefault();
+    if (!online || !link || !link->isUp() || address != this->address || port != this->port) {
+        refused++;
+        return nullptr;
+    }
+    connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                     [](const std::shared_ptr<HostConnection>& c) { return !c->open; }),
+                      connections.end());
+
+    std::shared_ptr<HostConnection> connection = std::make_shared<HostConnection>();
+    connection->link = link;
+    connection->open = true;
+    connection->sessionStarted = false;
+    connections.push_back(connection);
+    return connection;
+}
+
+bool HostBroker::handshake(const mbedtls_ssl_session& offered, mbedtls_ssl_session& session) {
+    if (failHandshakes) return false;
+    std::string offeredId((const char*)offered.id, offered.id_len);
+    if (resumeSessions && offered.id_len > 0 &&
+        std::find(tlsSessions.begin(), tlsSessions.end(), offeredId) != tlsSessions.end()) {
+        session = offered;
+        return true;
+    }
+    session.id_len = sizeof(session.id);
+    for (size_t i = 0; i < session.id_len; i++) {
+        session.id[i] = (uint8_t)((tlsSessions.size() + 1) * 31 + i);
+    }
+    tlsSessions.push_back(std::string((const char*)session.id, session.id_len));
+    return true;
+}
+
+void HostBroker::receive(HostConnection& connection, const uint8_t* data, size_t length) {
+    connection.fromClient.append((const char*)data, length);
+
+    // Handle every complete packet; a partial one waits for the rest
+    for (;;) {
+        const std::string& buffer = connection.fromClient;
+        if (buffer.size() < 2) return;
+        size_t remaining = 0;
+        size_t position = 1;
+        uint32_t multiplier = 1;
+        uint8_t digit;
+        do {
+            if (position >= buffer.size() || position > 4) return;
+            digit = buffer[position++];
+            remaining += (digit & 0x7F) * multiplier;
+            multiplier *= 128;
+        } while (digit & 0x80);
+        if (buffer.size() < position + remaining) return;
+
+        uint8_t header = buffer[0];
+        std::string body = buffer.substr(position, remaining);
+        connection.fromClient.erase(0, position + remaining);
+        handle(connection, header >> 4, header & 0x0F, (const uint8_t*)body.data(), body.size());
+        if (!connection.open) return;
+    }
+}
+
+void HostBroker::handle(HostConnection& connection, uint8_t type, uint8_t flags, const uint8_t* body, size_t length) {
+    switch (type) {
+        case MQTT_CONNECT: {
+            connects++;
+            uint8_t reply[2] = { 0, acceptConnect ? (uint8_t)0 : (uint8_t)CONNACK_NOT_AUTHORIZED };
+            send(connection, MQTT_CONNACK << 4, reply, sizeof(reply));
+            connection.sessionStarted = acceptConnect;
+            if (!acceptConnect) connection.open = false;
+            break;
+        }
+
+        case MQTT_PUBLISH: {
+            if (length < 2) return;
+            uint8_t qos = (flags >> 1) & 0x03;
+            size_t topicLength = (body[0] << 8) | body[1];
+            size_t position = 2 + topicLength;
+            if (position + (qos > 0 ? 2 : 0) > length) return;
+            std::string topic((const char*)body + 2, topicLength);
+            uint8_t id[2] = { 0, 0 };
+            if (qos > 0) {
+                id[0] = body[position];
+                id[1] = body[position + 1];
+                position += 2;
+            }
+            std::string payload((const char*)body + position, length - position);
+            received.push_back({ topic, payload, qos, millis() });
+            if (qos == 1 && ackPublishes) send(connection, MQTT_PUBACK << 4, id, sizeof(id));
+            deliver(topic, payload);
+            break;
+        }
+
+        case MQTT_SUBSCRIBE: {
+            if (length < 2) return;
+            std::string reply((const char*)body, 2);  // Packet identifier
+            size_t position = 2;
+            while (position + 2 <= length) {
+                size_t filterLength = (body[position] << 8) | body[position + 1];
+                position += 2;
+                if (position + filterLength + 1 > length) break;
+                connection.filters.push_back(std::string((const char*)body + position, filterLength));
+                position += filterLength + 1;  // Requested QoS
+                reply += '\0';                 // Every filter is granted QoS 0
+            }
+            send(connection, MQTT_SUBACK << 4, (const uint8_t*)reply.data(), reply.size());
+            break;
+        }
+
+        case MQTT_UNSUBSCRIBE: {
+            if (length < 2) return;
+            size_t position = 2;
+            while (position + 2 <= length) {
+                size_t filterLength = (body[position] << 8) | body[position + 1];
+                position += 2;
+                if (position + filterLength > length) break;
+                std::string filter((const char*)body + position, filterLength);
+                connection.filters.erase(std::remove(connection.filters.begin(), connection.filters.end(), filter),
+                                         connection.filters.end());
+                position += filterLength;
+            }
+            send(connection, MQTT_UNSUBACK << 4, body, 2);
+            break;
+        }
+
+        case MQTT_PINGREQ:
+            send(connection, MQTT_PINGRESP << 4, nullptr, 0);
+            break;
+
+        case MQTT_DISCONNECT:
+            connection.open = false;
+            break;
+
+        default:
+            break;  // PUBACKs for QoS 0 deliveries never arrive; anything else is ignored
+    }
+}
+
+void HostBroker::deliver(const std::string& topic, const std::string& payload) {
+    std::string body;
+    body += (char)(topic.size() >> 8);
+    body += (char)(topic.size() & 0xFF);
+    body += topic;
+    body += payload;
+
+    for (std::shared_ptr<HostConnection>& connection : connections) {
+        if (!connection->open || !connection->sessionStarted || !connection->link->isUp()) continue;
+        for (const std::string& filter : connection->filters) {
+            if (matches(filter.c_str(), topic.c_str())) {
+                send(*connection, MQTT_PUBLISH << 4, (const uint8_t*)body.data(), body.size());
+                break;
+            }
+        }
+    }
+}
+
+void HostBroker::publish(const char* topic, const char* payload) {
+    deliver(topic, payload);
+}
+
+void HostBroker::send(HostConnection& connection, uint8_t header, const uint8_t* body, size_t length) {
+    connection.toClient += (char)header;
+    size_t remaining = length;
+    do {
+        uint8_t digit = remaining % 128;
+        remaining /= 128;
+        if (remaining > 0) digit |= 0x80;
+        connection.toClient += (char)digit;
+    } while (remaining > 0);
+    if (length > 0) connection.toClient.append((const char*)body, length);
+}
+
+size_t HostBroker::countReceived(const char* topic) const {
+    size_t count = 0;
+    for (const BrokerMessage& message : received) {
+        if (message.topic == topic) count++;
+    }
+    return count;
+}
+
+size_t HostBroker::getOpenConnections() const {
+    size_t count = 0;
+    for (const std::shared_ptr<HostConnection>& connection : connections) {
+        if (connection->open) count++;
+    }
+    return count;
+}
+
+bool HostBroker::isSubscribed(const char* topic) const {
+    for (const std::shared_ptr<HostConnection>& connection : connections) {
+        if (!connection->open) continue;
+        for (const std::string& filter : connection->filters) {
+            if (matches(filter.c_str(), topic)) return true;
+        }
+    }
+    return false;
+}
+
+bool HostBroker::matches(const char* filter, const char* topic) {
+    while (*filter) {
+        if (filter[0] == '#') return true;  // Also matches the parent level
+        if (filter[0] == '+') {
+            while (*topic && *topic != '/') topic++;
+            filter++;
+        } else {
+            while (*filter && *filter != '/' && *filter == *topic) {
+                filter++;
+                topic++;
+            }
+            if (*filter && *filter != '/') return false;
+            if (*topic && *topic != '/') return false;
+        }
+        if (!*filter) return !*topic;
+        // Both are at a separator
+        if (!*topic) return strcmp(filter, "/#") == 0;
+        filter++;
+        topic++;
+    }
+    return !*topic;
+}
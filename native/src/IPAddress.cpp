@@ -0,0 +1,44 @@
+#include <Arduino.h>
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+IPAddress::IPAddress(uint32_t address) {
+    memcpy(bytes, &address, sizeof(bytes));
+}
+
+IPAddress::operator uint32_t() const {
+    uint32_t address;
+    memcpy(&address, bytes, sizeof(address));
+    return address;
+}
+
+bool IPAddress::fromString(const char* address) {
+    if (!address) return false;
+    uint8_t parsed[4];
+    int part = 0;
+    unsigned value = 0;
+    bool digit = false;
+    for (const char* p = address; ; p++) {
+        if (*p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            if (value > 255) return false;
+            digit = true;
+        } else if ((*p == '.' || *p == '\0') && digit && part < 4) {
+            parsed[part++] = value;
+            value = 0;
+            digit = false;
+            if (*p == '\0') break;
+        } else {
+            return false;
+        }
+    }
+    if (part != 4) return false;
+    memcpy(bytes, parsed, sizeof(bytes));
+    return true;
+}
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(text);
+}
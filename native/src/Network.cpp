@@ -0,0 +1,171 @@
+#include <WiFi.h>
+#include <ETH.h>
+#include <PPP.h>
+#include <SPI.h>
+#include <lwip/dns.h>
+#include <lwip/tcpip.h>
+#include <string>
+#include <vector>
+
+#define MAX_EVENT_CALLBACKS 4
+
+NetworkClass Network;
+WiFiClass WiFi;
+ETHClass ETH;
+PPPClass PPP;
+SPIClass SPI;
+
+FakeLink* FakeLink::defaultLink = nullptr;
+
+static NetworkEventCb eventCallbacks[MAX_EVENT_CALLBACKS];
+static size_t eventCallbackCount = 0;
+
+struct HostEntry {
+    std::string name;
+    IPAddress address;
+};
+static std::vector<HostEntry> hosts;
+
+FakeLink::FakeLink(const char* name, IPAddress address, arduino_event_id_t upEvent, arduino_event_id_t downEvent) :
+    name(name),
+    upEvent(upEvent),
+    downEvent(downEvent),
+    address(address),
+    available(true),
+    started(false),
+    bringUpTime(0),
+    upAt(0),
+    signal(-55)
+{
+    handle.name = name;
+}
+
+void FakeLink::setAvailable(bool available) {
+    if (available == this->available) return;
+    this->available = available;
+    if (available) upAt = millis() + bringUpTime;
+    if (started) Network.raise(available ? upEvent : downEvent);
+}
+
+void FakeLink::start() {
+    if (started) return;
+    started = true;
+    upAt = millis() + bringUpTime;
+}
+
+void FakeLink::stop() {
+    started = false;
+}
+
+bool FakeLink::isUp() const {
+    return started && available && (long)(millis() - upAt) >= 0;
+}
+
+bool FakeLink::setDefault() {
+    defaultLink = this;
+    return true;
+}
+
+esp_err_t esp_netif_get_netif_impl_name(esp_netif_t* netif, char* name) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+    if (!ssid || !*ssid) return WL_CONNECT_FAILED;
+    STA.start();
+    return status();
+}
+
+bool WiFiClass::config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAP) {
+    STA.stop();
+    return true;
+}
+
+wl_status_t WiFiClass::status() {
+    if (STA.isUp()) return WL_CONNECTED;
+    if (!STA.isStarted()) return WL_IDLE_STATUS;
+    return STA.isAvailable() ? WL_DISCONNECTED : WL_NO_SSID_AVAIL;
+}
+
+bool ETHClass::begin(eth_phy_type_t type, int32_t phyAddr, int cs, int irq, int rst, SPIClass& spi, uint8_t spiFreqMhz) {
+    start();
+    return true;
+}
+
+bool PPPClass::begin(ppp_modem_model_t model, uint8_t uart, int baud) {
+    start();
+    return true;
+}
+
+int PPPClass::waitStatusBits(int bits, uint32_t timeout) {
+    unsigned long started = millis();
+    while (!isUp() && millis() - started < timeout) {
+        delay(10);
+    }
+    return isUp() ? bits : 0;
+}
+
+int PPPClass::RSSI() {
+    int dBm = getSignal();
+    if (dBm == 0) return 99;
+    int csq = (dBm + 113) / 2;
+    return csq < 0 ? 0 : csq > 31 ? 31 : csq;
+}
+
+int NetworkClass::hostByName(const char* host, IPAddress& result) {
+    return result.fromString(host) || lookupHost(host, result);
+}
+
+bool NetworkClass::macAddress(uint8_t* mac) {
+    static const uint8_t hostMac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };  // Locally administered
+    memcpy(mac, hostMac, sizeof(hostMac));
+    return true;
+}
+
+void NetworkClass::onEvent(NetworkEventCb callback) {
+    if (eventCallbackCount < MAX_EVENT_CALLBACKS) eventCallbacks[eventCallbackCount++] = callback;
+}
+
+void NetworkClass::raise(arduino_event_id_t event) {
+    arduino_event_info_t info = {};
+    for (size_t i = 0; i < eventCallbackCount; i++) {
+        eventCallbacks[i](event, info);
+    }
+}
+
+void NetworkClass::addHost(const char* host, IPAddress address) {
+    for (HostEntry& entry : hosts) {
+        if (entry.name == host) {
+            entry.address = address;
+            return;
+        }
+    }
+    hosts.push_back({ host, address });
+}
+
+bool NetworkClass::lookupHost(const char* host, IPAddress& result) const {
+    for (const HostEntry& entry : hosts) {
+        if (entry.name == host) {
+            result = entry.address;
+            return true;
+        }
+    }
+    return false;
+}
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* address, dns_found_callback found, void* arg) {
+    IPAddress resolved;
+    if (!Network.hostByName(hostname, resolved)) return ERR_ARG;
+    address->type = IPADDR_TYPE_V4;
+    address->u_addr.ip4.addr = (uint32_t)resolved;
+    return ERR_OK;
+}
+
+err_t tcpip_callback(tcpip_callback_fn function, void* context) {
+    function(context);
+    return ERR_OK;
+}
@@ -0,0 +1,52 @@
+#include <Arduino.h>
+#include <stdarg.h>
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size--) {
+        if (write(*buffer++) == 0) break;
+        written++;
+    }
+    return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    if ((size_t)length < sizeof(small)) return write((const uint8_t*)small, length);
+
+    char* large = (char*)malloc(length + 1);
+    if (!large) return 0;
+    va_start(args, format);
+    vsnprintf(large, length + 1, format, args);
+    va_end(args);
+    size_t written = write((const uint8_t*)large, length);
+    free(large);
+    return written;
+}
+
+size_t Print::print(long n, int base) {
+    return print(String(n, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long n, int base) {
+    return print(String(n, (unsigned char)base));
+}
+
+size_t Print::print(double n, int digits) {
+    return print(String(n, (unsigned int)digits));
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = read();
+        if (c < 0) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
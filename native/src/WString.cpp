@@ -0,0 +1,82 @@
+#include <Arduino.h>
+
+static std::string formatInteger(unsigned long value, bool negative, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    char digits[72];
+    size_t length = 0;
+    do {
+        unsigned long digit = value % base;
+        digits[length++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value > 0);
+    if (negative) digits[length++] = '-';
+    std::reverse(digits, digits + length);
+    return std::string(digits, length);
+}
+
+String::String(int n, unsigned char base) : String((long)n, base) {}
+
+String::String(unsigned int n, unsigned char base) : String((unsigned long)n, base) {}
+
+String::String(long n, unsigned char base) {
+    bool negative = n < 0 && base == 10;
+    value = formatInteger(negative ? -(unsigned long)n : (unsigned long)n, negative, base);
+}
+
+String::String(unsigned long n, unsigned char base) {
+    value = formatInteger(n, false, base);
+}
+
+String::String(float n, unsigned int decimals) : String((double)n, decimals) {}
+
+String::String(double n, unsigned int decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, n);
+    value = buffer;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return value.length() >= suffix.value.length() &&
+           value.compare(value.length() - suffix.value.length(), suffix.value.length(), suffix.value) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t found = value.find(c, from);
+    return found == std::string::npos ? -1 : (int)found;
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+    size_t found = value.find(str.value, from);
+    return found == std::string::npos ? -1 : (int)found;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= value.length()) return String();
+    if (to > value.length()) to = value.length();
+    return String(value.substr(from, to - from).c_str());
+}
+
+void String::trim() {
+    size_t begin = value.find_first_not_of(" \t\r\n");
+    size_t end = value.find_last_not_of(" \t\r\n");
+    value = begin == std::string::npos ? "" : value.substr(begin, end - begin + 1);
+}
+
+String operator+(const String& left, const String& right) {
+    String result(left);
+    result.concat(right);
+    return result;
+}
+
+String operator+(const String& left, const char* right) {
+    String result(left);
+    result.concat(right);
+    return result;
+}
+
+String operator+(const char* left, const String& right) {
+    String result(left);
+    result.concat(right);
+    return result;
+}
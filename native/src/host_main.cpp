@@ -0,0 +1,274 @@
+// Host entry point for env:native. Runs the firmware's network and MQTT
+// modules against the scripted links and the in-process broker, one scenario
+// at a time, and exits non-zero if any of them fails. Simulated time makes
+// every run identical apart from the host timings in the throughput line,
+// so the output can be diffed between commits.
+//
+//   .pio/build/native/program [scenario] [data directory]
+//
+// The data directory (default native/data) is copied to a scratch directory
+// per scenario, so the outbox and config snapshot never touch the tree.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ETH.h>
+#include <PPP.h>
+#include <LittleFS.h>
+#include <esp_random.h>
+#include <chrono>
+#include "HostBroker.h"
+#include "NetworkController.h"
+#include "MQTTModule.h"
+#include "ConfigLoader.h"
+
+#define SCENARIO_TIMEOUT 60000  // Simulated ms any single wait may take
+#define THROUGHPUT_MESSAGES 200
+
+static NetworkController* netManager;
+static MQTTModule* mqtt;
+static const char* dataDirectory = "native/data";
+
+// Same wiring as setup() in main.cpp, minus the sensor and the tasks
+static void setupModules() {
+    hostSeedRandom(1);
+    WiFi.STA.setAvailable(true);
+    ETH.setAvailable(true);
+    PPP.setAvailable(true);
+
+    if (!ConfigLoader::loadConfig()) {
+        Serial.println("Failed to load config, using defaults");
+    }
+    const char* broker = ConfigLoader::getMQTTBroker();
+    Broker.listen(broker[0] ? broker : "broker.host", ConfigLoader::getMQTTPort());
+    Broker.setOnline(true);
+    Broker.clearReceived();
+
+    netManager = new NetworkController();
+    mqtt = new MQTTModule(netManager);
+
+    mqtt->setBroker(broker[0] ? broker : "broker.host", ConfigLoader::getMQTTPort());
+    mqtt->setCredentials(ConfigLoader::getMQTTClientId(), ConfigLoader::getMQTTUsername(), ConfigLoader::getMQTTPassword());
+    mqtt->setTopics(
+        ConfigLoader::getMQTTStatusTopic(),
+        ConfigLoader::getMQTTCommandTopic(),
+        ConfigLoader::getMQTTSensorTopic(),
+        ConfigLoader::getMQTTHeartbeatTopic()
+    );
+    mqtt->setHeartbeatFormat(ConfigLoader::getMQTTHeartbeatFormat());
+    mqtt->setMetricsTopic(ConfigLoader::getMQTTMetricsTopic());
+    mqtt->setDelivery(ConfigLoader::getMQTTQoS(), ConfigLoader::getMQTTInflightWindow(), ConfigLoader::getMQTTAckTimeout());
+    mqtt->setReconnect(ConfigLoader::getMQTTReconnect().baseDelay, ConfigLoader::getMQTTReconnect().maxDelay);
+    mqtt->setKeepAlive(ConfigLoader::getMQTTKeepAlive());
+    if (ConfigLoader::getMQTTOutboxEnabled()) {
+        mqtt->setOutbox(
+            ConfigLoader::getMQTTOutboxMaxBytes(),
+            ConfigLoader::getMQTTOutboxSegmentSize(),
+            ConfigLoader::getMQTTOutboxReplayBatch(),
+            ConfigLoader::getMQTTOutboxReplayInterval()
+        );
+    }
+
+    netManager->setWiFiCredentials(ConfigLoader::getWiFiSSID(), ConfigLoader::getWiFiPassword());
+    NetInterface priority[3];
+    size_t interfaceCount = ConfigLoader::getNetworkInterfaceCount();
+    for (size_t i = 0; i < interfaceCount; i++) {
+        priority[i] = ConfigLoader::getNetworkInterface(i);
+    }
+    netManager->setPriority(priority, interfaceCount);
+    netManager->setProbeTiming(ConfigLoader::getNetworkProbeInterval(), ConfigLoader::getNetworkProbeTimeout());
+    netManager->setSelection(ConfigLoader::getNetworkWeights(), ConfigLoader::getNetworkHysteresis(), ConfigLoader::getNetworkHoldTime());
+    netManager->setReconnect(ConfigLoader::getNetworkReconnect().baseDelay, ConfigLoader::getNetworkReconnect().maxDelay);
+    netManager->begin();
+
+    mqtt->loadCertsFromSPIFFS();
+}
+
+static void teardownModules() {
+    delete mqtt;
+    delete netManager;
+    mqtt = nullptr;
+    netManager = nullptr;
+    Broker.dropConnections();
+    WiFi.STA.stop();
+    ETH.stop();
+    PPP.stop();
+}
+
+// One pass of the network task, then a millisecond of simulated time
+static void step() {
+    netManager->update();
+    mqtt->update();
+    hostAdvance(1);
+}
+
+static bool runUntil(bool (*condition)(), unsigned long timeout = SCENARIO_TIMEOUT) {
+    unsigned long started = millis();
+    while (!condition()) {
+        if (millis() - started >= timeout) return false;
+        step();
+    }
+    return true;
+}
+
+static void runFor(unsigned long ms) {
+    unsigned long started = millis();
+    while (millis() - started < ms) step();
+}
+
+static bool mqttConnected() {
+    return mqtt->isConnected();
+}
+
+static bool mqttDisconnected() {
+    return !mqtt->isConnected();
+}
+
+#if BOARD_HAS_ETHERNET
+static bool onEthernet() {
+    return netManager->getCurrentInterface() == ETHERNET && mqtt->isConnected();
+}
+#endif
+
+static bool outboxDrained() {
+    return mqtt->getOutbox().getDepth() == 0 && mqtt->getInflightCount() == 0;
+}
+
+static bool publishSample(uint32_t sequence) {
+    char payload[64];
+    int length = snprintf(payload, sizeof(payload), "{\"seq\":%lu,\"temperature\":21.5}", (unsigned long)sequence);
+    return mqtt->publishSensor(payload, length);
+}
+
+#if BOARD_HAS_ETHERNET
+// WiFi (first in the list) drops; Ethernet, already up as a standby, carries the session
+static bool scenarioFailover() {
+    if (!runUntil(mqttConnected)) {
+        Serial.println("❌ Never connected");
+        return false;
+    }
+    if (netManager->getCurrentInterface() != WIFI) {
+        Serial.printf("❌ Started on %s instead of WiFi\n", NetworkController::interfaceName(netManager->getCurrentInterface()));
+        return false;
+    }
+    runFor(1000);  // Ethernet comes up as the standby
+
+    WiFi.STA.setAvailable(false);
+    unsigned long lost = millis();
+    if (!runUntil(onEthernet)) {
+        Serial.println("❌ Session did not move to Ethernet");
+        return false;
+    }
+    Serial.printf("Failover: link %lu ms, MQTT back after %lu ms, %lu failovers\n",
+                  (unsigned long)netManager->getLastFailoverMs(), millis() - lost,
+                  (unsigned long)netManager->getFailoverCount());
+    return true;
+}
+#endif
+
+// The broker goes away; publishes wait in the outbox and replay on reconnect
+static bool scenarioReconnect() {
+    if (!runUntil(mqttConnected)) {
+        Serial.println("❌ Never connected");
+        return false;
+    }
+    uint32_t connectsBefore = Broker.getConnects();
+    Broker.setOnline(false);
+    if (!runUntil(mqttDisconnected)) {
+        Serial.println("❌ Broker outage went unnoticed");
+        return false;
+    }
+
+    const uint32_t queued = 10;
+    for (uint32_t i = 0; i < queued; i++) {
+        publishSample(i);
+        runFor(1000);
+    }
+    uint32_t attempts = mqtt->getReconnectAttempts();
+
+    Broker.setOnline(true);
+    if (!runUntil(mqttConnected) || !runUntil(outboxDrained)) {
+        Serial.println("❌ Did not reconnect and drain the outbox");
+        return false;
+    }
+    size_t delivered = Broker.countReceived(ConfigLoader::getMQTTSensorTopic());
+    Serial.printf("Reconnect: %lu attempts while offline, outage %lu ms, %u/%lu replayed, %lu CONNECTs\n",
+                  (unsigned long)attempts, (unsigned long)mqtt->getLastOutageMs(), (unsigned)delivered,
+                  (unsigned long)queued, (unsigned long)(Broker.getConnects() - connectsBefore));
+    if (attempts == 0 || delivered != queued) {
+        Serial.println("❌ Expected backoff attempts and every queued message delivered");
+        return false;
+    }
+    return true;
+}
+
+// Publishes back to back; whatever the in-flight window cannot take goes through the outbox
+static bool scenarioThroughput() {
+    if (!runUntil(mqttConnected)) {
+        Serial.println("❌ Never connected");
+        return false;
+    }
+    Broker.clearReceived();
+    unsigned long simulatedStart = millis();
+    auto wallStart = std::chrono::steady_clock::now();
+
+    uint32_t direct = 0;
+    for (uint32_t i = 0; i < THROUGHPUT_MESSAGES; i++) {
+        if (publishSample(i)) direct++;
+        step();
+    }
+    if (!runUntil(outboxDrained)) {
+        Serial.println("❌ Outbox did not drain");
+        return false;
+    }
+
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    unsigned long simulatedMs = millis() - simulatedStart;
+    size_t delivered = Broker.countReceived(ConfigLoader::getMQTTSensorTopic());
+    Serial.printf("Throughput: %u/%u delivered (%lu direct) in %lu simulated ms, %.1f host ms (%.0f msg/s)\n",
+                  (unsigned)delivered, THROUGHPUT_MESSAGES, (unsigned long)direct, simulatedMs, wallMs,
+                  wallMs > 0 ? delivered * 1000.0 / wallMs : 0.0);
+    if (delivered != THROUGHPUT_MESSAGES) {
+        Serial.println("❌ Messages were lost");
+        return false;
+    }
+    return true;
+}
+
+struct Scenario {
+    const char* name;
+    bool (*run)();
+};
+
+static const Scenario scenarios[] = {
+#if BOARD_HAS_ETHERNET
+    { "failover", scenarioFailover },
+#endif
+    { "reconnect", scenarioReconnect },
+    { "throughput", scenarioThroughput },
+};
+
+int main(int argc, char** argv) {
+    const char* only = argc > 1 ? argv[1] : nullptr;
+    if (argc > 2) dataDirectory = argv[2];
+
+    int failed = 0;
+    int ran = 0;
+    for (const Scenario& scenario : scenarios) {
+        if (only && strcmp(only, scenario.name) != 0) continue;
+        Serial.printf("=== %s ===\n", scenario.name);
+        if (!LittleFS.mountCopy(dataDirectory)) return 1;
+        setupModules();
+        bool passed = scenario.run();
+        teardownModules();
+        LittleFS.removeCopy();
+        Serial.printf("%s %s\n", passed ? "✅" : "❌", scenario.name);
+        ran++;
+        if (!passed) failed++;
+    }
+    if (ran == 0) {
+        Serial.printf("❌ Unknown scenario '%s'\n", only);
+        return 1;
+    }
+    Serial.printf("%d/%d scenarios passed\n", ran - failed, ran);
+    return failed ? 1 : 0;
+}
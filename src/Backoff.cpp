@@ -0,0 +1,46 @@
+#include "Backoff.h"
+
+Backoff::Backoff() :
+    baseDelay(1000),
+    maxDelay(60000),
+    failures(0),
+    delay(0),
+    lastAttempt(0),
+    state(0x9E3779B9)
+{
+}
+
+void Backoff::configure(uint32_t baseDelay, uint32_t maxDelay, uint32_t seed) {
+    this->baseDelay = baseDelay > 0 ? baseDelay : 1;
+    this->maxDelay = maxDelay > this->baseDelay ? maxDelay : this->baseDelay;
+    state = seed != 0 ? seed : 0x9E3779B9;  // xorshift never leaves 0
+    reset();
+}
+
+uint32_t Backoff::nextRandom() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+uint32_t Backoff::getWindow() const {
+    if (failures == 0) return 0;
+    uint32_t window = baseDelay;
+    for (uint32_t i = 1; i < failures && window < maxDelay; i++) {
+        window = window > maxDelay / 2 ? maxDelay : window * 2;
+    }
+    return window;
+}
+
+void Backoff::schedule(uint32_t now) {
+    failures++;
+    uint32_t window = getWindow();
+    delay = (uint32_t)(((uint64_t)nextRandom() * (window + 1ULL)) >> 32);
+    lastAttempt = now;
+}
+
+void Backoff::reset() {
+    failures = 0;
+    delay = 0;
+}
@@ -0,0 +1,95 @@
+#include "CommandRouter.h"
+
+ArenaAllocator::ArenaAllocator(uint8_t* buffer, size_t capacity) : buffer(buffer), capacity(capacity) {
+    reset();
+}
+
+// Each block is preceded by its size so reallocate() can copy it
+size_t ArenaAllocator::blockSize(void* ptr) {
+    return *((size_t*)ptr - ALIGN / sizeof(size_t));
+}
+
+void* ArenaAllocator::allocate(size_t size) {
+    size_t rounded = (size + ALIGN - 1) & ~(ALIGN - 1);
+    if (rounded + ALIGN > capacity - used) return nullptr;
+
+    uint8_t* block = buffer + used + ALIGN;
+    *((size_t*)block - ALIGN / sizeof(size_t)) = rounded;
+    last = used;
+    used += rounded + ALIGN;
+    return block;
+}
+
+void ArenaAllocator::deallocate(void*) {
+    // Freed on reset()
+}
+
+void* ArenaAllocator::reallocate(void* ptr, size_t newSize) {
+    if (!ptr) return allocate(newSize);
+
+    size_t oldSize = blockSize(ptr);
+    size_t rounded = (newSize + ALIGN - 1) & ~(ALIGN - 1);
+
+    // The newest block (a growing string or the shrinking pool) resizes in place
+    if (last != SIZE_MAX && (uint8_t*)ptr == buffer + last + ALIGN) {
+        if (rounded + ALIGN > capacity - last) return nullptr;
+        *((size_t*)ptr - ALIGN / sizeof(size_t)) = rounded;
+        used = last + ALIGN + rounded;
+        return ptr;
+    }
+    if (rounded <= oldSize) return ptr;
+
+    void* moved = allocate(newSize);
+    if (moved) memcpy(moved, ptr, oldSize);
+    return moved;
+}
+
+CommandRouter::CommandRouter() : routeCount(0), arena(arenaBuffer, sizeof(arenaBuffer)), handled(0), unknown(0), rejected(0) {}
+
+bool CommandRouter::on(const char* action, CommandHandler handler) {
+    if (routeCount >= MAX_ROUTES) {
+        Serial.printf("❌ Command table full, cannot register '%s'\n", action);
+        return false;
+    }
+    routes[routeCount].action = action;
+    routes[routeCount].handler = handler;
+    routeCount++;
+    return true;
+}
+
+bool CommandRouter::dispatch(const char* payload, size_t length, PayloadFormat format) {
+    arena.reset();
+    JsonDocument doc(&arena);
+
+    DeserializationError error;
+    if (format == PAYLOAD_MSGPACK) {
+        error = deserializeMsgPack(doc, payload, length);
+    } else {
+        error = deserializeJson(doc, payload, length);
+    }
+    if (error) {
+        Serial.printf("❌ Command rejected: %s\n", error.c_str());
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    JsonObjectConst command = doc.as<JsonObjectConst>();
+    const char* action = command["action"];
+    if (!action) {
+        Serial.println("❌ Command rejected: missing action");
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    for (size_t i = 0; i < routeCount; i++) {
+        if (strcmp(routes[i].action, action) == 0) {
+            routes[i].handler(command);
+            handled.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    Serial.printf("❌ Unknown command action '%s'\n", action);
+    unknown.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
@@ -1,219 +1,690 @@
 #include "ConfigLoader.h"
+#include <ArduinoJson.h>
+#include <type_traits>
+
+#define CONFIG_JSON_PATH         "/config.json"
+#define CONFIG_SNAPSHOT_PATH     "/config.bin"
+#define CONFIG_SNAPSHOT_MAGIC    0x31474643  // "CFG1"
+#define CONFIG_SNAPSHOT_VERSION  12
+
+static_assert(std::is_trivially_copyable<DeviceConfig>::value, "DeviceConfig is written to flash as raw bytes");
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t sourceCrc;  // CRC of the config.json the snapshot was built from
+    uint32_t crc;        // CRC of the DeviceConfig that follows
+};
+
+DeviceConfig ConfigLoader::config;
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    while (length--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+template <size_t Size>
+static bool copyString(FixedString<Size>& dest, JsonVariantConst value, const char* fallback, const char* path) {
+    const char* str = value | fallback;
+    if (!dest.assign(str)) {
+        Serial.printf("❌ Config value %s too long (%u > %u chars)\n", path, (unsigned)strlen(str), (unsigned)dest.capacity());
+        dest.assign(fallback);
+        return false;
+    }
+    return true;
+}
+
+static bool parseIP(uint32_t& dest, JsonVariantConst value, const char* fallback, const char* path) {
+    IPAddress ip;
+    if (!ip.fromString(value | fallback)) {
+        Serial.printf("❌ Config value %s is not a valid IP address\n", path);
+        ip.fromString(fallback);
+        dest = (uint32_t)ip;
+        return false;
+    }
+    dest = (uint32_t)ip;
+    return true;
+}
+
+static bool parseStaticIP(StaticIPConfig& dest, JsonVariantConst value, const char* defaultIP, const char* path) {
+    char field[48];
+    bool valid = true;
+    dest.enabled = value["enabled"] | false;
+    snprintf(field, sizeof(field), "%s.ip", path);
+    valid &= parseIP(dest.ip, value["ip"], defaultIP, field);
+    snprintf(field, sizeof(field), "%s.gateway", path);
+    valid &= parseIP(dest.gateway, value["gateway"], "192.168.1.1", field);
+    snprintf(field, sizeof(field), "%s.subnet", path);
+    valid &= parseIP(dest.subnet, value["subnet"], "255.255.255.0", field);
+    snprintf(field, sizeof(field), "%s.dns1", path);
+    valid &= parseIP(dest.dns1, value["dns1"], "8.8.8.8", field);
+    snprintf(field, sizeof(field), "%s.dns2", path);
+    valid &= parseIP(dest.dns2, value["dns2"], "8.8.4.4", field);
+    return valid;
+}
+
+static bool parseFormat(uint8_t& dest, JsonVariantConst value, const char* path, const char* fallback = "json") {
+    const char* name = value | fallback;
+    if (strcmp(name, "json") == 0) {
+        dest = PAYLOAD_JSON;
+    } else if (strcmp(name, "msgpack") == 0) {
+        dest = PAYLOAD_MSGPACK;
+    } else {
+        Serial.printf("❌ Config value %s must be \"json\" or \"msgpack\"\n", path);
+        dest = PAYLOAD_JSON;
+        return false;
+    }
+    return true;
+}
+
+static bool parsePowerMode(uint8_t& dest, JsonVariantConst value) {
+    const char* name = value | "balanced";
+    if (strcmp(name, "performance") == 0) {
+        dest = POWER_PERFORMANCE;
+    } else if (strcmp(name, "balanced") == 0) {
+        dest = POWER_BALANCED;
+    } else if (strcmp(name, "low") == 0) {
+        dest = POWER_LOW;
+    } else {
+        Serial.println("❌ Config value power.mode must be \"performance\", \"balanced\" or \"low\"");
+        dest = POWER_BALANCED;
+        return false;
+    }
+    return true;
+}
+
+static void parseReport(ReportConfig& dest, JsonVariantConst value) {
+    dest.deadband = value["deadband"] | 0.0f;
+    dest.minInterval = value["minIntervalMs"] | 0;
+    dest.maxInterval = value["maxIntervalMs"] | 0;
+}
+
+static void parseReconnect(ReconnectConfig& dest, JsonVariantConst value, uint32_t baseDelay, uint32_t maxDelay) {
+    dest.baseDelay = value["baseMs"] | baseDelay;
+    dest.maxDelay = value["maxMs"] | maxDelay;
+}
+
+// Fills the typed config from a parsed document; missing keys get defaults
+static bool fillConfig(DeviceConfig& config, JsonVariantConst root) {
+    bool valid = true;
+    memset(static_cast<void*>(&config), 0, sizeof(config));  // Plain data; assigning DeviceConfig() would put a copy on the stack
+
+    JsonVariantConst wifi = root["wifi"];
+    valid &= copyString(config.wifi.ssid, wifi["ssid"], "", "wifi.ssid");
+    valid &= copyString(config.wifi.password, wifi["password"], "", "wifi.password");
+    valid &= parseStaticIP(config.wifi.staticIP, wifi["staticIP"], "192.168.1.150", "wifi.staticIP");
+
+    JsonVariantConst ethernet = root["ethernet"];
+    const char* mac = ethernet["mac"] | "DE:AD:BE:EF:FE:ED";
+    if (sscanf(mac, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", &config.ethernet.mac[0], &config.ethernet.mac[1], &config.ethernet.mac[2],
+               &config.ethernet.mac[3], &config.ethernet.mac[4], &config.ethernet.mac[5]) != 6) {
+        Serial.println("❌ Config value ethernet.mac is not a valid MAC address");
+        const uint8_t defaultMac[6] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED };
+        memcpy(config.ethernet.mac, defaultMac, sizeof(defaultMac));
+        valid = false;
+    }
+    valid &= parseStaticIP(config.ethernet.staticIP, ethernet["staticIP"], "192.168.1.100", "ethernet.staticIP");
+
+    JsonVariantConst network = root["network"];
+    JsonArrayConst interfaces = network["interfaces"];
+    if (interfaces.isNull()) {
+        config.network.priority[0] = WIFI;
+        config.network.interfaceCount = 1;
+    }
+    for (JsonVariantConst entry : interfaces) {
+        const char* name = entry | "";
+        int interface;
+        if (strcmp(name, "ethernet") == 0) interface = ETHERNET;
+        else if (strcmp(name, "wifi") == 0) interface = WIFI;
+        else if (strcmp(name, "lte") == 0) interface = LTE;
+        else {
+            Serial.printf("❌ Config network.interfaces has unknown interface '%s'\n", name);
+            valid = false;
+            continue;
+        }
+        bool duplicate = false;
+        for (uint8_t i = 0; i < config.network.interfaceCount; i++) {
+            duplicate |= config.network.priority[i] == interface;
+        }
+        if (!duplicate) config.network.priority[config.network.interfaceCount++] = interface;
+    }
+    if (config.network.interfaceCount == 0) {
+        Serial.println("❌ Config network.interfaces is empty, using wifi");
+        config.network.priority[0] = WIFI;
+        config.network.interfaceCount = 1;
+        valid = false;
+    }
+    config.network.probeInterval = network["probeIntervalMs"] | 30000;
+    config.network.probeTimeout = network["probeTimeoutMs"] | 3000;
+    JsonVariantConst weights = network["weights"];
+    config.network.weights.rtt = weights["rtt"] | 1.0f;
+    config.network.weights.loss = weights["loss"] | 1.0f;
+    config.network.weights.signal = weights["signal"] | 1.0f;
+    config.network.weights.priority = weights["priority"] | 5.0f;
+    int hysteresis = network["hysteresis"] | 10;
+    if (hysteresis < 0 || hysteresis > 100) {
+        Serial.println("❌ Config value network.hysteresis must be 0-100");
+        hysteresis = 10;
+        valid = false;
+    }
+    config.network.hysteresis = hysteresis;
+    config.network.holdTime = network["holdMs"] | 60000;
+    parseReconnect(config.network.reconnect, network["reconnect"], 2000, 60000);
+
+    JsonVariantConst lte = root["lte"];
+    valid &= copyString(config.lte.apn, lte["apn"], "", "lte.apn");
+    valid &= copyString(config.lte.user, lte["user"], "", "lte.user");
+    valid &= copyString(config.lte.pass, lte["pass"], "", "lte.pass");
+
+    JsonVariantConst mqtt = root["mqtt"];
+    valid &= copyString(config.mqtt.broker, mqtt["broker"], "", "mqtt.broker");
+    int port = mqtt["port"] | 8883;
+    if (port <= 0 || port > 65535) {
+        Serial.println("❌ Config value mqtt.port out of range");
+        port = 8883;
+        valid = false;
+    }
+    config.mqtt.port = port;
+    valid &= copyString(config.mqtt.clientId, mqtt["clientId"], "", "mqtt.clientId");
+    valid &= copyString(config.mqtt.username, mqtt["username"], "", "mqtt.username");
+    valid &= copyString(config.mqtt.password, mqtt["password"], "", "mqtt.password");
+
+    JsonVariantConst topics = mqtt["topics"];
+    valid &= copyString(config.mqtt.statusTopic, topics["status"], "home/status", "mqtt.topics.status");
+    valid &= copyString(config.mqtt.commandTopic, topics["command"], "home/command", "mqtt.topics.command");
+    valid &= copyString(config.mqtt.sensorTopic, topics["sensor"], "home/sensor", "mqtt.topics.sensor");
+    valid &= copyString(config.mqtt.heartbeatTopic, topics["heartbeat"], "home/heartbeat", "mqtt.topics.heartbeat");
+    valid &= copyString(config.mqtt.metricsTopic, topics["metrics"], "home/metrics", "mqtt.topics.metrics");
+
+    int qos = mqtt["qos"] | 1;
+    if (qos < 0 || qos > 1) {
+        Serial.println("❌ Config value mqtt.qos must be 0 or 1");
+        qos = 1;
+        valid = false;
+    }
+    config.mqtt.qos = qos;
+    int inflightWindow = mqtt["inflightWindow"] | 4;
+    if (inflightWindow < 1 || inflightWindow > 8) {
+        Serial.println("❌ Config value mqtt.inflightWindow must be 1-8");
+        inflightWindow = 4;
+        valid = false;
+    }
+    config.mqtt.inflightWindow = inflightWindow;
+    config.mqtt.ackTimeout = mqtt["ackTimeoutMs"] | 10000;
+    parseReconnect(config.mqtt.reconnect, mqtt["reconnect"], 2000, 120000);
+    config.mqtt.keepAlive = mqtt["keepAliveS"] | 15;
+
+    JsonArrayConst subscriptions = mqtt["subscriptions"];
+    for (JsonVariantConst filter : subscriptions) {
+        if (config.mqtt.subscriptionCount >= CONFIG_MAX_SUBSCRIPTIONS) {
+            Serial.printf("❌ Config mqtt.subscriptions has more than %d entries\n", CONFIG_MAX_SUBSCRIPTIONS);
+            valid = false;
+            break;
+        }
+        char field[32];
+        snprintf(field, sizeof(field), "mqtt.subscriptions[%u]", (unsigned)config.mqtt.subscriptionCount);
+        TopicString& dest = config.mqtt.subscriptions[config.mqtt.subscriptionCount];
+        if (copyString(dest, filter, "", field) && !dest.isEmpty()) {
+            config.mqtt.subscriptionCount++;
+        } else {
+            valid = false;
+        }
+    }
+
+    JsonVariantConst formats = mqtt["formats"];
+    valid &= parseFormat(config.mqtt.statusFormat, formats["status"], "mqtt.formats.status");
+    valid &= parseFormat(config.mqtt.commandFormat, formats["command"], "mqtt.formats.command");
+    valid &= parseFormat(config.mqtt.sensorFormat, formats["sensor"], "mqtt.formats.sensor");
+    valid &= parseFormat(config.mqtt.heartbeatFormat, formats["heartbeat"], "mqtt.formats.heartbeat");
+    valid &= parseFormat(config.mqtt.metricsFormat, formats["metrics"], "mqtt.formats.metrics", "msgpack");
+
+    JsonVariantConst outbox = mqtt["outbox"];
+    config.mqtt.outboxEnabled = outbox["enabled"] | true;
+    config.mqtt.outboxMaxBytes = outbox["maxBytes"] | 65536;
+    config.mqtt.outboxSegmentSize = outbox["segmentSize"] | 4096;
+    config.mqtt.outboxReplayBatch = outbox["replayBatch"] | 10;
+    config.mqtt.outboxReplayInterval = outbox["replayIntervalMs"] | 200;
+
+    JsonVariantConst batch = mqtt["batch"];
+    config.mqtt.batchSize = batch["size"] | 1;
+    config.mqtt.batchMaxAge = batch["maxAgeMs"] | 60000;
+
+    JsonVariantConst schedule = root["schedule"];
+    config.schedule.samplePeriod = schedule["sampleMs"] | 10000;
+    config.schedule.heartbeatInterval = schedule["heartbeatMs"] | 30000;
+    config.schedule.statusInterval = schedule["statusMs"] | 60000;
+    config.schedule.metricsInterval = schedule["metricsMs"] | 60000;
+    config.schedule.maxIdle = schedule["maxIdleMs"] | 1000;
+    if (config.schedule.samplePeriod == 0 || config.schedule.maxIdle == 0) {
+        Serial.println("❌ Config values schedule.sampleMs and schedule.maxIdleMs must be positive");
+        config.schedule.samplePeriod = 10000;
+        config.schedule.maxIdle = 1000;
+        valid = false;
+    }
 
-JsonDocument ConfigLoader::config;
+    JsonVariantConst power = root["power"];
+    valid &= parsePowerMode(config.power.mode, power["mode"]);
+    config.power.minCpuMhz = power["minCpuMhz"] | 80;
+    config.power.maxCpuMhz = power["maxCpuMhz"] | 240;
+
+    JsonVariantConst sensors = root["sensors"];
+    parseReport(config.sensors.temperature, sensors["temperature"]);
+    parseReport(config.sensors.humidity, sensors["humidity"]);
+
+    JsonVariantConst certs = root["certs"];
+    valid &= copyString(config.certs.caCert, certs["caCert"], "ca.pem", "certs.caCert");
+    valid &= copyString(config.certs.clientCert, certs["clientCert"], "client.pem", "certs.clientCert");
+    valid &= copyString(config.certs.privateKey, certs["privateKey"], "private.key", "certs.privateKey");
+
+    return valid;
+}
+
+void ConfigLoader::applyDefaults() {
+    fillConfig(config, JsonVariantConst());
+}
+
+uint32_t ConfigLoader::fileCrc(File& file) {
+    uint8_t chunk[128];
+    uint32_t crc = 0;
+    size_t read;
+    while ((read = file.read(chunk, sizeof(chunk))) > 0) {
+        crc = crc32Update(crc, chunk, read);
+    }
+    return crc;
+}
+
+bool ConfigLoader::loadSnapshot(uint32_t sourceCrc) {
+    File file = LittleFS.open(CONFIG_SNAPSHOT_PATH, "r");
+    if (!file) return false;
+
+    SnapshotHeader header;
+    DeviceConfig snapshot;
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == CONFIG_SNAPSHOT_MAGIC &&
+              header.version == CONFIG_SNAPSHOT_VERSION &&
+              header.size == sizeof(DeviceConfig) &&
+              header.sourceCrc == sourceCrc &&
+              file.read((uint8_t*)&snapshot, sizeof(snapshot)) == sizeof(snapshot) &&
+              crc32Update(0, (const uint8_t*)&snapshot, sizeof(snapshot)) == header.crc;
+    file.close();
+
+    if (ok) config = snapshot;
+    return ok;
+}
+
+void ConfigLoader::saveSnapshot(uint32_t sourceCrc) {
+    File file = LittleFS.open(CONFIG_SNAPSHOT_PATH, "w");
+    if (!file) {
+        Serial.println("Failed to write config snapshot");
+        return;
+    }
+    SnapshotHeader header = {
+        CONFIG_SNAPSHOT_MAGIC,
+        CONFIG_SNAPSHOT_VERSION,
+        sizeof(DeviceConfig),
+        sourceCrc,
+        crc32Update(0, (const uint8_t*)&config, sizeof(config))
+    };
+    file.write((const uint8_t*)&header, sizeof(header));
+    file.write((const uint8_t*)&config, sizeof(config));
+    file.close();
+}
+
+bool ConfigLoader::parseJson(File& file, bool& valid) {
+    uint32_t heapBefore = ESP.getFreeHeap();
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, file);
+    if (error) {
+        Serial.println("Failed to parse config.json");
+        return false;
+    }
+    uint32_t documentSize = heapBefore - ESP.getFreeHeap();
+
+    valid = fillConfig(config, doc.as<JsonVariantConst>());
+    Serial.printf("JSON document used %lu bytes of heap, typed config keeps %u\n", (unsigned long)documentSize, (unsigned)sizeof(DeviceConfig));
+    return true;  // doc is released here
+}
 
 bool ConfigLoader::loadConfig() {
+    unsigned long start = micros();
+    applyDefaults();
+
     if (!LittleFS.begin(true)) {
         Serial.println("LittleFS Mount Failed");
         return false;
     }
-    File file = LittleFS.open("/config.json", "r");
+    File file = LittleFS.open(CONFIG_JSON_PATH, "r");
     if (!file) {
         Serial.println("Failed to open config.json");
         return false;
     }
-    DeserializationError error = deserializeJson(config, file);
+
+    // The snapshot is only trusted if it was built from this exact config.json
+    uint32_t sourceCrc = fileCrc(file);
+    if (loadSnapshot(sourceCrc)) {
+        file.close();
+        Serial.printf("✅ Config loaded from snapshot in %lu us\n", micros() - start);
+        return true;
+    }
+
+    file.seek(0);
+    bool valid = false;
+    bool parsed = parseJson(file, valid);
     file.close();
-    if (error) {
-        Serial.println("Failed to parse config.json");
-        return false;
+    if (!parsed) return false;
+    if (!valid) {
+        // The rest of the file is in use, and the snapshot keeps it from being parsed every boot
+        Serial.println("❌ config.json failed validation, invalid values replaced by defaults");
     }
+
+    saveSnapshot(sourceCrc);
+    Serial.printf("✅ Config parsed from JSON in %lu us\n", micros() - start);
     return true;
 }
 
-String ConfigLoader::getWiFiSSID() {
-    return config["wifi"]["ssid"] | "";
+const char* ConfigLoader::getWiFiSSID() {
+    return config.wifi.ssid.c_str();
 }
 
-String ConfigLoader::getWiFiPassword() {
-    return config["wifi"]["password"] | "";
+const char* ConfigLoader::getWiFiPassword() {
+    return config.wifi.password.c_str();
 }
 
-String ConfigLoader::getMQTTBroker() {
-    return config["mqtt"]["broker"] | "";
+const char* ConfigLoader::getMQTTBroker() {
+    return config.mqtt.broker.c_str();
 }
 
 int ConfigLoader::getMQTTPort() {
-    return config["mqtt"]["port"] | 8883;
+    return config.mqtt.port;
 }
 
-String ConfigLoader::getMQTTClientId() {
-    return config["mqtt"]["clientId"] | "";
+const char* ConfigLoader::getMQTTClientId() {
+    return config.mqtt.clientId.c_str();
 }
 
-String ConfigLoader::getMQTTUsername() {
-    return config["mqtt"]["username"] | "";
+const char* ConfigLoader::getMQTTUsername() {
+    return config.mqtt.username.c_str();
 }
 
-String ConfigLoader::getMQTTPassword() {
-    return config["mqtt"]["password"] | "";
+const char* ConfigLoader::getMQTTPassword() {
+    return config.mqtt.password.c_str();
 }
 
 void ConfigLoader::getEthernetMAC(byte mac[6]) {
-    String macStr = config["ethernet"]["mac"] | "DE:AD:BE:EF:FE:ED";
-    sscanf(macStr.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]);
+    memcpy(mac, config.ethernet.mac, 6);
 }
 
 IPAddress ConfigLoader::getEthernetIP() {
-    String ipStr = config["ethernet"]["staticIP"]["ip"] | "192.168.1.100";
-    return IPAddress(ipStr.c_str());
+    return IPAddress(config.ethernet.staticIP.ip);
 }
 
 IPAddress ConfigLoader::getEthernetGateway() {
-    String gwStr = config["ethernet"]["staticIP"]["gateway"] | "192.168.1.1";
-    return IPAddress(gwStr.c_str());
+    return IPAddress(config.ethernet.staticIP.gateway);
 }
 
 IPAddress ConfigLoader::getEthernetSubnet() {
-    String snStr = config["ethernet"]["staticIP"]["subnet"] | "255.255.255.0";
-    return IPAddress(snStr.c_str());
+    return IPAddress(config.ethernet.staticIP.subnet);
 }
 
 bool ConfigLoader::getEthernetStaticIPEnabled() {
-    return config["ethernet"]["staticIP"]["enabled"] | false;
+    return config.ethernet.staticIP.enabled;
 }
 
 IPAddress ConfigLoader::getEthernetStaticIP() {
-    String ipStr = config["ethernet"]["staticIP"]["ip"] | "192.168.1.100";
-    return IPAddress(ipStr.c_str());
+    return IPAddress(config.ethernet.staticIP.ip);
 }
 
 IPAddress ConfigLoader::getEthernetStaticGateway() {
-    String gwStr = config["ethernet"]["staticIP"]["gateway"] | "192.168.1.1";
-    return IPAddress(gwStr.c_str());
+    return IPAddress(config.ethernet.staticIP.gateway);
 }
 
 IPAddress ConfigLoader::getEthernetStaticSubnet() {
-    String snStr = config["ethernet"]["staticIP"]["subnet"] | "255.255.255.0";
-    return IPAddress(snStr.c_str());
+    return IPAddress(config.ethernet.staticIP.subnet);
 }
 
 IPAddress ConfigLoader::getEthernetStaticDNS1() {
-    String dns1Str = config["ethernet"]["staticIP"]["dns1"] | "8.8.8.8";
-    return IPAddress(dns1Str.c_str());
+    return IPAddress(config.ethernet.staticIP.dns1);
 }
 
 IPAddress ConfigLoader::getEthernetStaticDNS2() {
-    String dns2Str = config["ethernet"]["staticIP"]["dns2"] | "8.8.4.4";
-    return IPAddress(dns2Str.c_str());
+    return IPAddress(config.ethernet.staticIP.dns2);
+}
+
+size_t ConfigLoader::getNetworkInterfaceCount() {
+    return config.network.interfaceCount;
+}
+
+NetInterface ConfigLoader::getNetworkInterface(size_t index) {
+    return (NetInterface)config.network.priority[index < config.network.interfaceCount ? index : 0];
+}
+
+unsigned long ConfigLoader::getNetworkProbeInterval() {
+    return config.network.probeInterval;
+}
+
+unsigned long ConfigLoader::getNetworkProbeTimeout() {
+    return config.network.probeTimeout;
+}
+
+const LinkWeights& ConfigLoader::getNetworkWeights() {
+    return config.network.weights;
 }
 
-String ConfigLoader::getLTEAPN() {
-    return config["lte"]["apn"] | "";
+uint8_t ConfigLoader::getNetworkHysteresis() {
+    return config.network.hysteresis;
 }
 
-String ConfigLoader::getLTEUser() {
-    return config["lte"]["user"] | "";
+unsigned long ConfigLoader::getNetworkHoldTime() {
+    return config.network.holdTime;
 }
 
-String ConfigLoader::getLTEPass() {
-    return config["lte"]["pass"] | "";
+const ReconnectConfig& ConfigLoader::getNetworkReconnect() {
+    return config.network.reconnect;
 }
 
-String ConfigLoader::getCACertFilename() {
-    return config["certs"]["caCert"] | "ca.pem";
+const char* ConfigLoader::getLTEAPN() {
+    return config.lte.apn.c_str();
 }
 
-String ConfigLoader::getClientCertFilename() {
-    return config["certs"]["clientCert"] | "client.pem";
+const char* ConfigLoader::getLTEUser() {
+    return config.lte.user.c_str();
 }
 
-String ConfigLoader::getPrivateKeyFilename() {
-    return config["certs"]["privateKey"] | "private.key";
+const char* ConfigLoader::getLTEPass() {
+    return config.lte.pass.c_str();
+}
+
+const char* ConfigLoader::getCACertFilename() {
+    return config.certs.caCert.c_str();
+}
+
+const char* ConfigLoader::getClientCertFilename() {
+    return config.certs.clientCert.c_str();
+}
+
+const char* ConfigLoader::getPrivateKeyFilename() {
+    return config.certs.privateKey.c_str();
 }
 
 bool ConfigLoader::getWiFiStaticIPEnabled() {
-    return config["wifi"]["staticIP"]["enabled"] | false;
+    return config.wifi.staticIP.enabled;
 }
 
 IPAddress ConfigLoader::getWiFiStaticIP() {
-    String ipStr = config["wifi"]["staticIP"]["ip"] | "192.168.1.150";
-    return IPAddress(ipStr.c_str());
+    return IPAddress(config.wifi.staticIP.ip);
 }
 
 IPAddress ConfigLoader::getWiFiStaticGateway() {
-    String gwStr = config["wifi"]["staticIP"]["gateway"] | "192.168.1.1";
-    return IPAddress(gwStr.c_str());
+    return IPAddress(config.wifi.staticIP.gateway);
 }
 
 IPAddress ConfigLoader::getWiFiStaticSubnet() {
-    String snStr = config["wifi"]["staticIP"]["subnet"] | "255.255.255.0";
-    return IPAddress(snStr.c_str());
+    return IPAddress(config.wifi.staticIP.subnet);
 }
 
 IPAddress ConfigLoader::getWiFiStaticDNS1() {
-    String dns1Str = config["wifi"]["staticIP"]["dns1"] | "8.8.8.8";
-    return IPAddress(dns1Str.c_str());
+    return IPAddress(config.wifi.staticIP.dns1);
 }
 
 IPAddress ConfigLoader::getWiFiStaticDNS2() {
-    String dns2Str = config["wifi"]["staticIP"]["dns2"] | "8.8.4.4";
-    return IPAddress(dns2Str.c_str());
+    return IPAddress(config.wifi.staticIP.dns2);
 }
 
-String ConfigLoader::getMQTTStatusTopic() {
-    return config["mqtt"]["topics"]["status"] | "home/status";
+const char* ConfigLoader::getMQTTStatusTopic() {
+    return config.mqtt.statusTopic.c_str();
 }
 
-String ConfigLoader::getMQTTCommandTopic() {
-    return config["mqtt"]["topics"]["command"] | "home/command";
+const char* ConfigLoader::getMQTTCommandTopic() {
+    return config.mqtt.commandTopic.c_str();
 }
 
-String ConfigLoader::getMQTTSensorTopic() {
-    return config["mqtt"]["topics"]["sensor"] | "home/sensor";
+const char* ConfigLoader::getMQTTSensorTopic() {
+    return config.mqtt.sensorTopic.c_str();
 }
 
-String ConfigLoader::getMQTTHeartbeatTopic() {
-    return config["mqtt"]["topics"]["heartbeat"] | "home/heartbeat";
+const char* ConfigLoader::getMQTTHeartbeatTopic() {
+    return config.mqtt.heartbeatTopic.c_str();
 }
 
-String ConfigLoader::loadCACert() {
-    if (!LittleFS.begin(false)) {  // false = don't format if mount fails
-        Serial.println("LittleFS not initialized for CA cert loading");
-        return "";
-    }
-    String filename = "/" + getCACertFilename();
-    File file = LittleFS.open(filename, "r");
-    if (!file) {
-        Serial.print("Failed to open CA cert file: ");
-        Serial.println(filename);
-        return "";
-    }
-    String cert = file.readString();
-    file.close();
-    return cert;
+const char* ConfigLoader::getMQTTMetricsTopic() {
+    return config.mqtt.metricsTopic.c_str();
 }
 
-String ConfigLoader::loadClientCert() {
-    if (!LittleFS.begin(false)) {  // false = don't format if mount fails
-        Serial.println("LittleFS not initialized for client cert loading");
-        return "";
-    }
-    String filename = "/" + getClientCertFilename();
-    File file = LittleFS.open(filename, "r");
-    if (!file) {
-        Serial.print("Failed to open client cert file: ");
-        Serial.println(filename);
-        return "";
-    }
-    String cert = file.readString();
-    file.close();
-    return cert;
+uint8_t ConfigLoader::getMQTTQoS() {
+    return config.mqtt.qos;
 }
 
-String ConfigLoader::loadPrivateKey() {
-    if (!LittleFS.begin(false)) {  // false = don't format if mount fails
-        Serial.println("LittleFS not initialized for private key loading");
-        return "";
-    }
-    String filename = "/" + getPrivateKeyFilename();
-    File file = LittleFS.open(filename, "r");
-    if (!file) {
-        Serial.print("Failed to open private key file: ");
-        Serial.println(filename);
-        return "";
-    }
-    String key = file.readString();
-    file.close();
-    return key;
-}
\ No newline at end of file
+size_t ConfigLoader::getMQTTInflightWindow() {
+    return config.mqtt.inflightWindow;
+}
+
+unsigned long ConfigLoader::getMQTTAckTimeout() {
+    return config.mqtt.ackTimeout;
+}
+
+const ReconnectConfig& ConfigLoader::getMQTTReconnect() {
+    return config.mqtt.reconnect;
+}
+
+uint16_t ConfigLoader::getMQTTKeepAlive() {
+    return config.mqtt.keepAlive;
+}
+
+size_t ConfigLoader::getMQTTSubscriptionCount() {
+    return config.mqtt.subscriptionCount;
+}
+
+const char* ConfigLoader::getMQTTSubscription(size_t index) {
+    return index < config.mqtt.subscriptionCount ? config.mqtt.subscriptions[index].c_str() : "";
+}
+
+PayloadFormat ConfigLoader::getMQTTStatusFormat() {
+    return (PayloadFormat)config.mqtt.statusFormat;
+}
+
+PayloadFormat ConfigLoader::getMQTTCommandFormat() {
+    return (PayloadFormat)config.mqtt.commandFormat;
+}
+
+PayloadFormat ConfigLoader::getMQTTSensorFormat() {
+    return (PayloadFormat)config.mqtt.sensorFormat;
+}
+
+PayloadFormat ConfigLoader::getMQTTHeartbeatFormat() {
+    return (PayloadFormat)config.mqtt.heartbeatFormat;
+}
+
+PayloadFormat ConfigLoader::getMQTTMetricsFormat() {
+    return (PayloadFormat)config.mqtt.metricsFormat;
+}
+
+bool ConfigLoader::getMQTTOutboxEnabled() {
+    return config.mqtt.outboxEnabled;
+}
+
+size_t ConfigLoader::getMQTTOutboxMaxBytes() {
+    return config.mqtt.outboxMaxBytes;
+}
+
+size_t ConfigLoader::getMQTTOutboxSegmentSize() {
+    return config.mqtt.outboxSegmentSize;
+}
+
+size_t ConfigLoader::getMQTTOutboxReplayBatch() {
+    return config.mqtt.outboxReplayBatch;
+}
+
+unsigned long ConfigLoader::getMQTTOutboxReplayInterval() {
+    return config.mqtt.outboxReplayInterval;
+}
+
+size_t ConfigLoader::getMQTTBatchSize() {
+    return config.mqtt.batchSize;
+}
+
+unsigned long ConfigLoader::getMQTTBatchMaxAge() {
+    return config.mqtt.batchMaxAge;
+}
+
+unsigned long ConfigLoader::getSamplePeriod() {
+    return config.schedule.samplePeriod;
+}
+
+unsigned long ConfigLoader::getHeartbeatInterval() {
+    return config.schedule.heartbeatInterval;
+}
+
+unsigned long ConfigLoader::getStatusInterval() {
+    return config.schedule.statusInterval;
+}
+
+unsigned long ConfigLoader::getMetricsInterval() {
+    return config.schedule.metricsInterval;
+}
+
+unsigned long ConfigLoader::getMaxIdle() {
+    return config.schedule.maxIdle;
+}
+
+PowerMode ConfigLoader::getPowerMode() {
+    return (PowerMode)config.power.mode;
+}
+
+uint16_t ConfigLoader::getPowerMinCpuMhz() {
+    return config.power.minCpuMhz;
+}
+
+uint16_t ConfigLoader::getPowerMaxCpuMhz() {
+    return config.power.maxCpuMhz;
+}
+
+float ConfigLoader::getTemperatureDeadband() {
+    return config.sensors.temperature.deadband;
+}
+
+unsigned long ConfigLoader::getTemperatureMinInterval() {
+    return config.sensors.temperature.minInterval;
+}
+
+unsigned long ConfigLoader::getTemperatureMaxInterval() {
+    return config.sensors.temperature.maxInterval;
+}
+
+float ConfigLoader::getHumidityDeadband() {
+    return config.sensors.humidity.deadband;
+}
+
+unsigned long ConfigLoader::getHumidityMinInterval() {
+    return config.sensors.humidity.minInterval;
+}
+
+unsigned long ConfigLoader::getHumidityMaxInterval() {
+    return config.sensors.humidity.maxInterval;
+}
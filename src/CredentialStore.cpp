@@ -0,0 +1,196 @@
+#include "CredentialStore.h"
+#include "ConfigLoader.h"
+
+// Reads one ASN.1 tag/length header; returns false if it runs past the buffer
+static bool readTLV(const uint8_t* data, size_t size, size_t& pos, uint8_t& tag, size_t& length) {
+    if (pos + 2 > size) return false;
+    tag = data[pos++];
+    uint8_t first = data[pos++];
+    if (first < 0x80) {
+        length = first;
+    } else {
+        uint8_t count = first & 0x7F;
+        if (count == 0 || count > 3 || pos + count > size) return false;
+        length = 0;
+        while (count--) length = (length << 8) | data[pos++];
+    }
+    return pos + length <= size;
+}
+
+CredentialStore::CredentialStore() : loaded(false) {
+    caCert = { "CA certificate", CERTIFICATE, nullptr, 0, 0, 0 };
+    clientCert = { "client certificate", CERTIFICATE, nullptr, 0, 0, 0 };
+    privateKey = { "private key", PRIVATE_KEY, nullptr, 0, 0, 0 };
+}
+
+CredentialStore::~CredentialStore() {
+    release(caCert);
+    release(clientCert);
+    release(privateKey);
+}
+
+void CredentialStore::release(Credential& cred) {
+    free(cred.data);
+    cred.data = nullptr;
+    cred.length = 0;
+    cred.fileSize = 0;
+    cred.lastWrite = 0;
+}
+
+bool CredentialStore::isPEM(const char* text) {
+    const char* begin = strstr(text, "-----BEGIN ");
+    return begin && strstr(begin, "-----END ") != nullptr;
+}
+
+const char* CredentialStore::derLabel(Kind kind, const uint8_t* data, size_t size) {
+    size_t pos = 0;
+    uint8_t tag;
+    size_t length;
+    if (!readTLV(data, size, pos, tag, length) || tag != 0x30 || pos + length != size) return nullptr;
+    if (kind == CERTIFICATE) return "CERTIFICATE";
+
+    // Tell the private key containers apart by what follows the version field
+    if (!readTLV(data, size, pos, tag, length) || tag != 0x02) return nullptr;
+    uint8_t version = length > 0 ? data[pos + length - 1] : 0;
+    pos += length;
+    if (!readTLV(data, size, pos, tag, length)) return nullptr;
+    if (tag == 0x30) return "PRIVATE KEY";              // PKCS#8
+    if (tag == 0x02) return "RSA PRIVATE KEY";          // PKCS#1
+    if (tag == 0x04 && version == 1) return "EC PRIVATE KEY";  // SEC1
+    return nullptr;
+}
+
+char* CredentialStore::derToPEM(const char* label, const uint8_t* data, size_t size, size_t& length) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    size_t encoded = ((size + 2) / 3) * 4;
+    size_t capacity = 2 * (strlen(label) + 16) + encoded + encoded / 64 + 2 + 1;
+    char* pem = (char*)malloc(capacity);
+    if (!pem) return nullptr;
+
+    size_t out = snprintf(pem, capacity, "-----BEGIN %s-----\n", label);
+    size_t column = 0;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t chunk = (uint32_t)data[i] << 16;
+        if (i + 1 < size) chunk |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < size) chunk |= data[i + 2];
+        pem[out++] = alphabet[(chunk >> 18) & 0x3F];
+        pem[out++] = alphabet[(chunk >> 12) & 0x3F];
+        pem[out++] = i + 1 < size ? alphabet[(chunk >> 6) & 0x3F] : '=';
+        pem[out++] = i + 2 < size ? alphabet[chunk & 0x3F] : '=';
+        column += 4;
+        if (column == 64) {
+            pem[out++] = '\n';
+            column = 0;
+        }
+    }
+    if (column > 0) pem[out++] = '\n';
+    out += snprintf(pem + out, capacity - out, "-----END %s-----\n", label);
+    length = out;
+    return pem;
+}
+
+bool CredentialStore::load(Credential& cred, const char* filename) {
+    String path = String("/") + filename;
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        Serial.printf("No %s found (%s)\n", cred.label, path.c_str());
+        release(cred);
+        return false;
+    }
+
+    size_t size = file.size();
+    time_t lastWrite = file.getLastWrite();
+    if (size == 0 || size > MAX_FILE_SIZE) {
+        Serial.printf("❌ %s has invalid size (%u bytes), skipping\n", cred.label, (unsigned)size);
+        file.close();
+        release(cred);
+        return false;
+    }
+
+    uint8_t* raw = (uint8_t*)malloc(size + 1);
+    if (!raw) {
+        Serial.printf("❌ Out of memory loading %s\n", cred.label);
+        file.close();
+        return false;
+    }
+    size_t read = file.read(raw, size);
+    file.close();
+    raw[read] = '\0';
+
+    char* data = nullptr;
+    size_t length = 0;
+    if (read == size && isPEM((const char*)raw)) {
+        data = (char*)raw;
+        length = size;
+    } else {
+        // NetworkClientSecure only accepts PEM text, so re-encode DER once here
+        const char* label = read == size ? derLabel(cred.kind, raw, size) : nullptr;
+        if (label) data = derToPEM(label, raw, size, length);
+        free(raw);
+    }
+    if (!data) {
+        Serial.printf("❌ %s is neither valid PEM nor DER, skipping\n", cred.label);
+        release(cred);
+        return false;
+    }
+
+    free(cred.data);
+    cred.data = data;
+    cred.length = length;
+    cred.fileSize = size;
+    cred.lastWrite = lastWrite;
+    Serial.printf("Loaded %s (%u bytes)\n", cred.label, (unsigned)length);
+    return true;
+}
+
+bool CredentialStore::hasChanged(const Credential& cred, const char* filename) {
+    String path = String("/") + filename;
+    File file = LittleFS.open(path, "r");
+    if (!file) return cred.data != nullptr;
+    bool changed = file.size() != cred.fileSize || file.getLastWrite() != cred.lastWrite;
+    file.close();
+    return changed;
+}
+
+bool CredentialStore::load() {
+    if (!LittleFS.begin(false)) {  // false = don't format if mount fails
+        Serial.println("LittleFS not initialized for certificate loading");
+        return false;
+    }
+
+    Serial.println("Loading certificates from LittleFS...");
+    load(caCert, ConfigLoader::getCACertFilename());
+    load(clientCert, ConfigLoader::getClientCertFilename());
+    load(privateKey, ConfigLoader::getPrivateKeyFilename());
+    loaded = true;
+    Serial.println("Certificate loading completed");
+    return caCert.data != nullptr;
+}
+
+bool CredentialStore::refreshIfChanged() {
+    if (!loaded) return load();
+
+    bool changed = false;
+    if (hasChanged(caCert, ConfigLoader::getCACertFilename())) {
+        load(caCert, ConfigLoader::getCACertFilename());
+        changed = true;
+    }
+    if (hasChanged(clientCert, ConfigLoader::getClientCertFilename())) {
+        load(clientCert, ConfigLoader::getClientCertFilename());
+        changed = true;
+    }
+    if (hasChanged(privateKey, ConfigLoader::getPrivateKeyFilename())) {
+        load(privateKey, ConfigLoader::getPrivateKeyFilename());
+        changed = true;
+    }
+    if (changed) Serial.println("Certificates changed on flash and were reloaded");
+    return changed;
+}
+
+void CredentialStore::apply(NetworkClientSecure& client) {
+    // Setting nullptr clears anything the client held from an earlier load
+    client.setCACert(caCert.data);
+    client.setCertificate(clientCert.data);
+    client.setPrivateKey(privateKey.data);
+}
@@ -1,6 +1,9 @@
-#include "EthernetModule.h"
 #include "board.h"
 
+#if BOARD_HAS_ETHERNET
+
+#include "EthernetModule.h"
+
 EthernetModule::EthernetModule(int sck, int miso, int mosi, int cs, int addr, int irq, int rst) : connected(false), staticIPEnabled(false), sck(sck), miso(miso), mosi(mosi), cs(cs), addr(addr), irq(irq), rst(rst) {
     // Default MAC, can be set later
     mac[0] = 0xDE; mac[1] = 0xAD; mac[2] = 0xBE; mac[3] = 0xEF; mac[4] = 0xFE; mac[5] = 0xED;
@@ -50,7 +53,8 @@ void EthernetModule::disconnect() {
 }
 
 bool EthernetModule::isConnected() {
-    connected = ETH.linkUp();
+    // A cable without a DHCP lease cannot carry traffic yet
+    connected = ETH.linkUp() && ETH.hasIP();
     return connected;
 }
 
@@ -67,4 +71,6 @@ String EthernetModule::getMAC() {
     char macStr[18];
     sprintf(macStr, "%02X:%02X:%02X:%02X:%02X:%02X", currentMac[0], currentMac[1], currentMac[2], currentMac[3], currentMac[4], currentMac[5]);
     return String(macStr);
-}
\ No newline at end of file
+}
+
+#endif // BOARD_HAS_ETHERNET
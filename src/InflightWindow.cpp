@@ -0,0 +1,187 @@
+#include "InflightWindow.h"
+
+#define MQTT_PUBLISH_QOS1  0x32
+#define MQTT_PUBLISH_DUP   0x08
+#define MQTT_PUBACK        4
+#define MQTT_SUBACK        9
+#define MQTT_SUBACK_FAILED 0x80
+
+InflightWindow::InflightWindow() : windowSize(0), count(0), sequence(0), ackTimeout(10000), ackTime(LATENCY_MS_BOUNDS, 8), subackObserver(nullptr), subackContext(nullptr) {
+    memset(&stats, 0, sizeof(stats));
+    for (size_t i = 0; i < MAX_WINDOW; i++) {
+        slots[i].used = false;
+    }
+    resetScanner();
+}
+
+void InflightWindow::configure(size_t windowSize, unsigned long ackTimeout) {
+    if (windowSize > MAX_WINDOW) {
+        Serial.printf("In-flight window %u exceeds %u, clamping\n", (unsigned)windowSize, (unsigned)MAX_WINDOW);
+        windowSize = MAX_WINDOW;
+    }
+    this->windowSize = windowSize;
+    this->ackTimeout = ackTimeout;
+}
+
+bool InflightWindow::contains(uint16_t packetId) const {
+    for (size_t i = 0; i < MAX_WINDOW; i++) {
+        if (slots[i].used && slots[i].packetId == packetId) return true;
+    }
+    return false;
+}
+
+bool InflightWindow::fits(size_t topicLength, size_t payloadLength) {
+    // Type byte, up to 2 length bytes at this size, topic length, packet ID
+    return 1 + 2 + 2 + topicLength + 2 + payloadLength <= INFLIGHT_SLOT_SIZE;
+}
+
+bool InflightWindow::send(Client& client, const char* topic, const uint8_t* payload, size_t length, uint16_t packetId) {
+    size_t topicLength = strlen(topic);
+    if (!hasRoom() || !fits(topicLength, length)) return false;
+
+    Slot* slot = nullptr;
+    for (size_t i = 0; i < MAX_WINDOW && !slot; i++) {
+        if (!slots[i].used) slot = &slots[i];
+    }
+
+    uint8_t* p = slot->packet;
+    size_t remaining = 2 + topicLength + 2 + length;
+    *p++ = MQTT_PUBLISH_QOS1;
+    do {
+        uint8_t digit = remaining % 128;
+        remaining /= 128;
+        if (remaining > 0) digit |= 0x80;
+        *p++ = digit;
+    } while (remaining > 0);
+    *p++ = topicLength >> 8;
+    *p++ = topicLength & 0xFF;
+    memcpy(p, topic, topicLength);
+    p += topicLength;
+    *p++ = packetId >> 8;
+    *p++ = packetId & 0xFF;
+    memcpy(p, payload, length);
+    p += length;
+
+    slot->used = true;
+    slot->packetId = packetId;
+    slot->length = p - slot->packet;
+    slot->sequence = sequence++;
+    slot->sentAt = millis();
+    count++;
+    stats.sent++;
+
+    client.write(slot->packet, slot->length);
+    return true;
+}
+
+size_t InflightWindow::resend(Client& client) {
+    // Oldest first, so the broker sees the original order
+    size_t resent = 0;
+    uint32_t after = 0;
+    bool first = true;
+    while (true) {
+        Slot* next = nullptr;
+        for (size_t i = 0; i < MAX_WINDOW; i++) {
+            Slot& slot = slots[i];
+            if (!slot.used || (!first && (int32_t)(slot.sequence - after) <= 0)) continue;
+            if (!next || (int32_t)(slot.sequence - next->sequence) < 0) next = &slot;
+        }
+        if (!next) break;
+
+        next->packet[0] |= MQTT_PUBLISH_DUP;
+        next->sentAt = millis();
+        client.write(next->packet, next->length);
+        stats.retransmitted++;
+        resent++;
+        after = next->sequence;
+        first = false;
+    }
+    return resent;
+}
+
+bool InflightWindow::isStalled(unsigned long now) const {
+    for (size_t i = 0; i < MAX_WINDOW; i++) {
+        if (slots[i].used && now - slots[i].sentAt > ackTimeout) return true;
+    }
+    return false;
+}
+
+void InflightWindow::acknowledge(uint16_t packetId) {
+    for (size_t i = 0; i < MAX_WINDOW; i++) {
+        Slot& slot = slots[i];
+        if (!slot.used || slot.packetId != packetId) continue;
+        uint32_t elapsed = millis() - slot.sentAt;
+        stats.acked++;
+        stats.lastAckMs = elapsed;
+        ackTime.record(elapsed);
+        if (elapsed > stats.maxAckMs) stats.maxAckMs = elapsed;
+        slot.used = false;
+        count--;
+        return;
+    }
+}
+
+void InflightWindow::setSubackObserver(SubackObserver observer, void* context) {
+    subackObserver = observer;
+    subackContext = context;
+}
+
+void InflightWindow::resetScanner() {
+    scanState = SCAN_TYPE;
+}
+
+void InflightWindow::scan(const uint8_t* data, size_t length) {
+    size_t i = 0;
+    while (i < length) {
+        switch (scanState) {
+            case SCAN_TYPE:
+                scanType = data[i++] >> 4;
+                scanRemaining = 0;
+                scanMultiplier = 1;
+                scanLengthBytes = 0;
+                scanId = 0;
+                scanIdBytes = 0;
+                scanRefused = false;
+                scanState = SCAN_LENGTH;
+                break;
+
+            case SCAN_LENGTH: {
+                uint8_t digit = data[i++];
+                scanRemaining += (digit & 0x7F) * scanMultiplier;
+                scanMultiplier *= 128;
+                scanLengthBytes++;
+                if (digit & 0x80) {
+                    // A fourth length byte must be the last; more means the stream is out of sync
+                    if (scanLengthBytes == 4) scanState = SCAN_TYPE;
+                } else {
+                    scanState = scanRemaining > 0 ? SCAN_BODY : SCAN_TYPE;
+                }
+                break;
+            }
+
+            case SCAN_BODY:
+                if ((scanType == MQTT_PUBACK || scanType == MQTT_SUBACK) && scanIdBytes < 2) {
+                    scanId = (scanId << 8) | data[i++];
+                    scanIdBytes++;
+                    scanRemaining--;
+                } else if (scanType == MQTT_SUBACK) {
+                    // One return code per requested filter
+                    if (data[i++] == MQTT_SUBACK_FAILED) scanRefused = true;
+                    scanRemaining--;
+                } else {
+                    // Skip bodies we do not care about in one step
+                    size_t skip = length - i < scanRemaining ? length - i : scanRemaining;
+                    i += skip;
+                    scanRemaining -= skip;
+                }
+                if (scanRemaining == 0) {
+                    if (scanType == MQTT_PUBACK && scanIdBytes == 2) acknowledge(scanId);
+                    if (scanType == MQTT_SUBACK && scanIdBytes == 2 && subackObserver) {
+                        subackObserver(subackContext, scanId, scanRefused);
+                    }
+                    scanState = SCAN_TYPE;
+                }
+                break;
+        }
+    }
+}
@@ -1,24 +1,34 @@
-#include "LTEModule.h"
 #include "board.h"
 
-LTEModule::LTEModule(HardwareSerial* serial, int rst, int tx, int rx, int rts, int cts) : serial(serial), connected(false) {
+#if BOARD_HAS_LTE
+
+#include "LTEModule.h"
+
+LTEModule::LTEModule(int tx, int rx, int rts, int cts, int rst) : tx(tx), rx(rx), rts(rts), cts(cts), rst(rst), connected(false) {
+}
+
+void LTEModule::begin() {
     // Configure PPP
     PPP.setApn(apn.c_str());
-    PPP.setPin("0000");  // Default PIN
+    if (pass.isEmpty()) PPP.setPin("0000");  // Default PIN
     if (rst != -1) PPP.setResetPin(rst, false, 200);  // Active HIGH, 200ms delay
     if (tx != -1 && rx != -1) {
         PPP.setPins(tx, rx, rts, cts, (rts != -1 && cts != -1) ? ESP_MODEM_FLOW_CONTROL_HW : ESP_MODEM_FLOW_CONTROL_NONE);
     }
     // For Quectel EC25, use PPP_MODEM_SIM7600 or similar
-    PPP.begin(LTE_MODEM_TYPE);
+    PPP.begin(LTE_MODEM_TYPE, LTE_SERIAL_NUM, LTE_SERIAL_BAUD);
 }
 
-void LTEModule::setAPN(const String& apn, const String& user, const String& pass) {
-    this->apn = apn;
-    this->user = user;
-    this->pass = pass;
-    PPP.setApn(apn.c_str());
-    PPP.setPin(pass.c_str());  // Use pass as PIN if provided
+bool LTEModule::setAPN(const char* apn, const char* user, const char* pass) {
+    if (!this->apn.assign(apn) || !this->user.assign(user) || !this->pass.assign(pass)) {
+        Serial.printf("❌ LTE APN, user or password too long (max %u, %u and %u chars)\n", (unsigned)APNString::capacity(),
+                      (unsigned)LTECredentialString::capacity(), (unsigned)LTECredentialString::capacity());
+        this->apn.clear();
+        return false;
+    }
+    PPP.setApn(this->apn.c_str());
+    PPP.setPin(this->pass.c_str());  // Use pass as PIN if provided
+    return true;
 }
 
 bool LTEModule::connect() {
@@ -50,9 +60,12 @@ void LTEModule::disconnect() {
 }
 
 bool LTEModule::isConnected() {
+    if (connected) connected = PPP.connected();  // Notice a dropped data session
     return connected;
 }
 
 IPAddress LTEModule::getIP() {
     return IPAddress(0,0,0,0); // Stub
-}
\ No newline at end of file
+}
+
+#endif // BOARD_HAS_LTE
@@ -1,40 +1,71 @@
 #include "MQTTModule.h"
-
-MQTTModule::MQTTModule(NetworkController* net) : netController(net), port(8883), connected(false) {
-    mqttClient = new PubSubClient(netClient);
+#include "PayloadWriter.h"
+#include <lwip/dns.h>
+#include <lwip/tcpip.h>
+#include <esp_random.h>
+#include <limits.h>
+
+#define DNS_PENDING 0
+#define DNS_DONE    1
+#define DNS_FAILED  2
+
+#define PUBLISH_OVERHEAD 7  // PubSubClient reserves a 5-byte fixed header, then the topic length
+
+MQTTModule::MQTTModule(NetworkController* net) : mqttClient(netClient), netController(net), port(8883), connected(false), lastConnectFailed(false), state(MQTT_STATE_IDLE), stateStarted(0), reconnectNow(false), sessionInterface(WIFI), outageStarted(0), lastOutageMs(0), keepAlive(MQTT_KEEPALIVE), dnsStatus(DNS_PENDING), dnsAddress(0), heartbeatFormat(PAYLOAD_JSON), replayBatch(10), replayInterval(200), lastReplay(0),
+    handshakeTime(LATENCY_MS_BOUNDS, 8),
+    reconnectTime{ { RECONNECT_MS_BOUNDS, 6 }, { RECONNECT_MS_BOUNDS, 6 }, { RECONNECT_MS_BOUNDS, 6 } },
+    streaming(false), streamRemaining(0), commandCallback(nullptr), packetId(0), subackWaiting(false), subackPending(0), subackSentAt(0) {
+    mqttClient.setSocketTimeout(connackTimeout);
+    mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
+    netClient.setReadObserver(onSocketRead, this);
+    inflight.setSubackObserver(onSuback, this);
+    retry.configure(2000, 120000, esp_random());
 }
 
-MQTTModule::~MQTTModule() {
-    delete mqttClient;
+// Copies one setting into its fixed-size field, naming it in the log if it does not fit
+template <size_t Size>
+static bool assignSetting(FixedString<Size>& dest, const char* value, const char* name) {
+    if (dest.assign(value)) return true;
+    Serial.printf("❌ MQTT %s too long (%u > %u chars)\n", name, (unsigned)strlen(value), (unsigned)dest.capacity());
+    return false;
 }
 
-void MQTTModule::setBroker(const String& broker, int port) {
-    this->broker = broker;
+bool MQTTModule::setBroker(const char* broker, int port) {
+    bool ok = assignSetting(this->broker, broker, "broker");
     this->port = port;
-    mqttClient->setServer(broker.c_str(), port);
-    mqttClient->setCallback([this](char* topic, byte* payload, unsigned int length) {
+    mqttClient.setServer(this->broker.c_str(), port);
+    mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
         this->callback(topic, payload, length);
     });
+    return ok;
 }
 
-void MQTTModule::setCredentials(const String& clientId, const String& username, const String& password) {
-    this->clientId = clientId;
-    this->username = username;
-    this->password = password;
+bool MQTTModule::setCredentials(const char* clientId, const char* username, const char* password) {
+    bool ok = assignSetting(this->clientId, clientId, "client ID");
+    ok &= assignSetting(this->username, username, "username");
+    ok &= assignSetting(this->password, password, "password");
+    return ok;
 }
 
-void MQTTModule::setTopics(const String& status, const String& command, const String& sensor, const String& heartbeat) {
-    this->statusTopic = status;
-    this->commandTopic = command;
-    this->sensorTopic = sensor;
-    this->heartbeatTopic = heartbeat;
+bool MQTTModule::setTopics(const char* status, const char* command, const char* sensor, const char* heartbeat) {
+    bool ok = assignSetting(statusTopic, status, "status topic");
+    ok &= assignSetting(commandTopic, command, "command topic");
+    ok &= assignSetting(sensorTopic, sensor, "sensor topic");
+    ok &= assignSetting(heartbeatTopic, heartbeat, "heartbeat topic");
 
     // Ensure callback is set up with the updated topics
-    if (mqttClient) {
-        mqttClient->setCallback([this](char* topic, byte* payload, unsigned int length) {
-            this->callback(topic, payload, length);
-        });
-    }
+    mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
+        this->callback(topic, payload, length);
+    });
+    return ok;
+}
+
+bool MQTTModule::setMetricsTopic(const char* topic) {
+    return assignSetting(metricsTopic, topic, "metrics topic");
+}
+
+void MQTTModule::setHeartbeatFormat(PayloadFormat format) {
+    heartbeatFormat = format;
 }
 
 void MQTTModule::setCACert(const char* caCert) {
@@ -42,194 +73,546 @@ void MQTTModule::setCACert(const char* caCert) {
 }
 
 void MQTTModule::loadCertsFromSPIFFS() {
-    static bool initialLoad = true;
-
-    if (initialLoad) {
-        Serial.println("Loading certificates from SPIFFS...");
-        initialLoad = false;
-    } else {
-        Serial.println("Reloading certificates for reconnection...");
+    // Buffers stay owned by the store, so the pointers handed to netClient remain valid
+    if (!credentials.isLoaded()) {
+        credentials.load();
     }
+    credentials.apply(netClient);
+}
 
-    // Load CA certificate
-    String caCert = ConfigLoader::loadCACert();
-    if (caCert.length() > 0 && caCert.length() < 10000) {  // Reasonable size check
-        if (initialLoad) Serial.printf("Setting CA certificate (%d bytes)\n", caCert.length());
-        netClient.setCACert(caCert.c_str());
-    } else if (caCert.length() >= 10000) {
-        Serial.println("CA certificate too large, skipping");
-    } else {
-        if (initialLoad) Serial.println("No CA certificate found");
-    }
+void MQTTModule::setCommandCallback(MQTTMessageCallback cb) {
+    commandCallback = cb;
+}
 
-    // Load client certificate
-    String clientCert = ConfigLoader::loadClientCert();
-    if (clientCert.length() > 0 && clientCert.length() < 10000) {
-        if (initialLoad) Serial.printf("Setting client certificate (%d bytes)\n", clientCert.length());
-        netClient.setCertificate(clientCert.c_str());
-    } else if (clientCert.length() >= 10000) {
-        Serial.println("Client certificate too large, skipping");
-    } else {
-        if (initialLoad) Serial.println("No client certificate found");
-    }
+void MQTTModule::setDelivery(uint8_t qos, size_t inflightWindow, unsigned long ackTimeout) {
+    inflight.configure(qos >= 1 ? inflightWindow : 0, ackTimeout);
+}
 
-    // Load private key
-    String privateKey = ConfigLoader::loadPrivateKey();
-    if (privateKey.length() > 0 && privateKey.length() < 10000) {
-        if (initialLoad) Serial.printf("Setting private key (%d bytes)\n", privateKey.length());
-        netClient.setPrivateKey(privateKey.c_str());
-    } else if (privateKey.length() >= 10000) {
-        Serial.println("Private key too large, skipping");
-    } else {
-        if (initialLoad) Serial.println("No private key found");
-    }
+void MQTTModule::setKeepAlive(uint16_t seconds) {
+    keepAlive = seconds > 0 ? seconds : MQTT_KEEPALIVE;
+    mqttClient.setKeepAlive(keepAlive);
+}
 
-    if (initialLoad) {
-        Serial.println("Certificate loading completed");
-    } else {
-        Serial.println("Certificate reloading completed");
+void MQTTModule::setReconnect(unsigned long baseDelay, unsigned long maxDelay) {
+    retry.configure(baseDelay, maxDelay, esp_random());
+}
+
+void MQTTModule::onSocketRead(void* context, const uint8_t* data, size_t length) {
+    // PubSubClient drops PUBACKs, so they are picked out of the byte stream here
+    MQTTModule* self = (MQTTModule*)context;
+    self->inflight.scan(data, length);
+}
+
+void MQTTModule::onSuback(void* context, uint16_t packetId, bool refused) {
+    MQTTModule* self = (MQTTModule*)context;
+    if (refused) {
+        // Retrying will not change the broker's ACL, so this is only reported
+        Serial.printf("❌ Broker refused a topic filter (SUBSCRIBE %u)\n", (unsigned)packetId);
     }
+    // The broker answers in order, so the latest SUBACK covers any earlier SUBSCRIBE
+    if (packetId == self->subackPending) self->subackWaiting = false;
+}
+
+void MQTTModule::setOutbox(size_t maxBytes, size_t segmentSize, size_t replayBatch, unsigned long replayInterval) {
+    this->replayBatch = replayBatch;
+    this->replayInterval = replayInterval;
+    outbox.begin(maxBytes, segmentSize);
 }
 
 bool MQTTModule::connect() {
-    if (connected || broker.isEmpty()) return false;
+    if (state != MQTT_STATE_IDLE || broker.isEmpty()) return false;
 
     Serial.println("Attempting MQTT connection...");
 
-    // Reload certificates before connecting (in case of corruption)
-    loadCertsFromSPIFFS();
+    // Certificates are cached; only check flash for updates after a failed attempt
+    if (!credentials.isLoaded()) {
+        loadCertsFromSPIFFS();
+    } else if (lastConnectFailed && credentials.refreshIfChanged()) {
+        credentials.apply(netClient);
+    }
 
-    mqttClient->setServer(broker.c_str(), port);
+    mqttClient.setServer(broker.c_str(), port);
+    enterState(MQTT_STATE_RESOLVING);
+    startResolve();
+    return true;
+}
 
-    if (mqttClient->connect(clientId.c_str(), username.c_str(), password.c_str())) {
-        connected = true;
-        Serial.println("✅ MQTT connected successfully");
+void MQTTModule::enterState(MQTTConnectionState next) {
+    state = next;
+    stateStarted = millis();
+}
 
-        // Subscribe to command topic after successful connection
-        if (!commandTopic.isEmpty()) {
-            delay(100);  // Small delay before subscribing
-            if (subscribe(commandTopic.c_str())) {
-                Serial.println("✅ Subscribed to command topic: " + commandTopic);
+unsigned long MQTTModule::stateTimeout() const {
+    switch (state) {
+        case MQTT_STATE_RESOLVING:      return resolveTimeout;
+        case MQTT_STATE_TCP_CONNECTING: return tcpTimeout;
+        case MQTT_STATE_TLS_HANDSHAKE:  return handshakeTimeout;
+        case MQTT_STATE_CONNECTING:     return connackTimeout * 1000UL;
+        default:                        return 0;
+    }
+}
+
+void MQTTModule::startResolve() {
+    IPAddress literal;
+    if (literal.fromString(broker.c_str())) {
+        dnsAddress = (uint32_t)literal;
+        dnsStatus = DNS_DONE;
+        return;
+    }
+    // A late answer for an abandoned lookup of the same host is harmless
+    dnsStatus = DNS_PENDING;
+    if (tcpip_callback(lookupHost, this) != ERR_OK) {
+        dnsStatus = DNS_FAILED;
+    }
+}
+
+void MQTTModule::lookupHost(void* arg) {
+    // Runs on the lwIP thread; dns_gethostbyname never blocks
+    MQTTModule* self = (MQTTModule*)arg;
+    ip_addr_t address;
+    err_t err = dns_gethostbyname(self->broker.c_str(), &address, dnsFound, self);
+    if (err == ERR_OK) {
+        dnsFound(self->broker.c_str(), &address, self);
+    } else if (err != ERR_INPROGRESS) {
+        dnsFound(self->broker.c_str(), nullptr, self);
+    }
+}
+
+void MQTTModule::dnsFound(const char* name, const ip_addr_t* address, void* arg) {
+    MQTTModule* self = (MQTTModule*)arg;
+    if (address && IP_IS_V4(address)) {
+        self->dnsAddress = ip4_addr_get_u32(ip_2_ip4(address));
+        self->dnsStatus = DNS_DONE;
+    } else {
+        self->dnsStatus = DNS_FAILED;
+    }
+}
+
+void MQTTModule::stepConnection() {
+    switch (state) {
+        case MQTT_STATE_RESOLVING:
+            if (dnsStatus == DNS_FAILED) {
+                failConnection("DNS lookup failed");
+            } else if (dnsStatus == DNS_DONE) {
+                // Lets the network controller check standby links against the same broker
+                netController->setProbeTarget(IPAddress((uint32_t)dnsAddress), port);
+                enterState(MQTT_STATE_TCP_CONNECTING);
+            }
+            break;
+
+        case MQTT_STATE_TCP_CONNECTING:
+            // Bounded by the client's connection timeout; TLS setup runs here too
+            netClient.setConnectionTimeout(tcpTimeout);
+            inflight.resetScanner();
+            if (netClient.beginConnect(IPAddress((uint32_t)dnsAddress), broker.c_str(), port)) {
+                enterState(MQTT_STATE_TLS_HANDSHAKE);
             } else {
-                Serial.println("❌ Failed to subscribe to command topic");
+                failConnection("TCP connect failed");
             }
+            break;
+
+        case MQTT_STATE_TLS_HANDSHAKE: {
+            int result = netClient.handshakeStep();
+            if (result > 0) {
+                handshakeTime.record(millis() - stateStarted);
+                enterState(MQTT_STATE_CONNECTING);
+            } else if (result < 0) {
+                failConnection("TLS handshake failed");
+            }
+            break;
         }
 
-        return true;
+        case MQTT_STATE_CONNECTING:
+            // The socket is already up, so PubSubClient only sends CONNECT and waits for CONNACK
+            if (mqttClient.connect(clientId.c_str(), username.c_str(), password.c_str())) {
+                enterState(MQTT_STATE_SUBSCRIBING);
+            } else {
+                failConnection("broker refused CONNECT");
+            }
+            break;
+
+        case MQTT_STATE_SUBSCRIBING:
+            connected = true;
+            lastConnectFailed = false;
+            retry.reset();
+            sessionInterface = netController->getCurrentInterface();
+            if (outageStarted != 0) {
+                lastOutageMs = millis() - outageStarted;
+                outageStarted = 0;
+                reconnectTime[sessionInterface].record(lastOutageMs);
+                Serial.printf("MQTT back after %lu ms\n", (unsigned long)lastOutageMs);
+            }
+            lastReplay = millis() - replayInterval;  // Start draining the outbox on the next update
+            enterState(MQTT_STATE_CONNECTED);
+            Serial.println("✅ MQTT connected successfully");
+
+            if (inflight.size() > 0) {
+                Serial.printf("Resent %u unacknowledged publishes\n", (unsigned)inflight.resend(netClient));
+            }
+
+            subackWaiting = false;
+            if (subscribeToCommands()) {
+                Serial.printf("✅ Subscribed to %u topic filters\n", (unsigned)subscriptions.size());
+            } else {
+                Serial.println("❌ Failed to subscribe to topic filters");
+            }
+            break;
+
+        default:
+            break;
     }
+}
 
-    Serial.println("❌ MQTT connection failed");
-    return false;
+void MQTTModule::failConnection(const char* reason) {
+    Serial.printf("❌ MQTT connection failed (%s)\n", reason);
+    netClient.stop();
+    connected = false;
+    lastConnectFailed = true;
+    connectFailures.add();
+    retry.schedule(millis());
+    Serial.printf("Next MQTT attempt in %lu ms (attempt %lu)\n", (unsigned long)retry.getDelay(), (unsigned long)retry.getFailures() + 1);
+    enterState(MQTT_STATE_IDLE);
+}
+
+void MQTTModule::handleConnectionLost() {
+    Serial.println("MQTT connection lost, cleaning up...");
+    netClient.stop();
+    if (connected) outageStarted = millis();
+    connected = false;
+    // Jitter even the first attempt: a broker restart drops the whole fleet at once
+    retry.schedule(millis());
+    enterState(MQTT_STATE_IDLE);
 }
 
 void MQTTModule::disconnect() {
-    if (connected) {
+    if (state != MQTT_STATE_IDLE) {
         Serial.println("MQTT disconnecting...");
-        mqttClient->disconnect();
+        if (connected) mqttClient.disconnect();
         connected = false;
 
         // Reset NetworkClientSecure state
         netClient.stop();
-        delay(100);  // Allow time for cleanup
+        enterState(MQTT_STATE_IDLE);
 
         Serial.println("MQTT disconnected and cleaned up");
     }
 }
 
 bool MQTTModule::isConnected() {
-    bool wasConnected = connected;
-    connected = mqttClient->connected();
-
-    // If we just disconnected, clean up
-    if (wasConnected && !connected) {
-        Serial.println("MQTT connection lost, cleaning up...");
-        netClient.stop();
-        delay(100);
+    if (connected && !mqttClient.connected()) {
+        handleConnectionLost();
     }
-
     return connected;
 }
 
 void MQTTModule::update() {
-    static unsigned long lastReconnectAttempt = 0;
-    const unsigned long reconnectDelay = 5000;  // 5 seconds between reconnection attempts
-
-    if (connected) {
-        mqttClient->loop();
-    } else if (netController->getState() == CONNECTED) {
-        // Only attempt reconnection if enough time has passed
-        if (millis() - lastReconnectAttempt > reconnectDelay) {
+    if (streaming) return;  // A half-written PUBLISH must not be interleaved with other packets
+    if (state == MQTT_STATE_CONNECTED) {
+        if (!isConnected()) return;
+
+        // The session's interface is gone or traffic moved to another one; the
+        // socket may not notice for minutes, so reconnect over the new default route
+        if (netController->getState() != CONNECTED || netController->getCurrentInterface() != sessionInterface) {
+            Serial.println("Network interface changed, moving MQTT session");
+            handleConnectionLost();
+            reconnectNow = true;
+            return;
+        }
+
+        mqttClient.loop();
+
+        // A PUBACK that never arrives means the link died without the socket noticing
+        if (inflight.isStalled(millis())) {
+            Serial.println("❌ PUBACK overdue");
+            handleConnectionLost();
+            return;
+        }
+        // Without the SUBACK the commands may never arrive; reconnecting subscribes again
+        if (subackWaiting && millis() - subackSentAt > subackTimeout) {
+            Serial.println("❌ SUBACK overdue");
+            handleConnectionLost();
+            return;
+        }
+
+        // Replay stored messages a batch at a time so loop() keeps being serviced
+        if (outbox.getDepth() > 0 && millis() - lastReplay >= replayInterval) {
+            lastReplay = millis();
+            size_t sent = outbox.replay(replayBatch, [this](const char* topic, const uint8_t* payload, size_t length) {
+                // Stored under a larger buffer, or before publish() checked the size
+                if (!canEverSend(topic, length)) return MQTTOutbox::REPLAY_REJECTED;
+                return sendPublish(topic, payload, length) ? MQTTOutbox::REPLAY_SENT : MQTTOutbox::REPLAY_RETRY;
+            });
+            if (sent > 0) {
+                Serial.printf("Outbox replayed %u messages, %lu pending\n", (unsigned)sent, (unsigned long)outbox.getDepth());
+            }
+        }
+    } else if (state == MQTT_STATE_IDLE) {
+        if (netController->getState() == CONNECTED && (reconnectNow || retry.isDue(millis()))) {
+            reconnectNow = false;
             Serial.println("Network is connected, attempting MQTT reconnection...");
-            lastReconnectAttempt = millis();
             connect();
         }
+    } else if (netController->getState() != CONNECTED) {
+        failConnection("network went down");
+    } else if (stateTimeout() > 0 && millis() - stateStarted > stateTimeout()) {
+        // SUBSCRIBING has no limit; it completes on the next update()
+        failConnection("timed out");
+    } else {
+        stepConnection();
+    }
+}
+
+unsigned long MQTTModule::getPollDelay(unsigned long now) const {
+    switch (state) {
+        case MQTT_STATE_IDLE:
+            if (netController->getState() != CONNECTED) return ULONG_MAX;
+            return reconnectNow ? 0 : retry.msUntilDue(now);
+        case MQTT_STATE_CONNECTED: {
+            // PubSubClient pings from loop(); a quarter of the keepalive keeps the
+            // PINGREQ well inside the broker's 1.5x grace even after a long sleep
+            unsigned long wait = keepAlive * 250UL;
+            if (outbox.getDepth() > 0) {
+                unsigned long replayDue = now - lastReplay >= replayInterval ? 0 : replayInterval - (now - lastReplay);
+                if (replayDue < wait) wait = replayDue;
+            }
+            if (subackWaiting) {
+                unsigned long subackDue = now - subackSentAt >= subackTimeout ? 0 : subackTimeout - (now - subackSentAt);
+                if (subackDue < wait) wait = subackDue;
+            }
+            return wait;
+        }
+        default:
+            return MQTT_CONNECT_POLL;  // Each update() advances the handshake by one step
     }
 }
 
 bool MQTTModule::publish(const char* topic, const char* payload) {
-    if (!connected) return false;
-    return mqttClient->publish(topic, payload);
+    return publish(topic, (const uint8_t*)payload, strlen(payload));
+}
+
+// Whether the whole PUBLISH fits the buffer it is built in; one that does not
+// fails on every attempt. With QoS 1 configured that is an in-flight slot,
+// since falling back to QoS 0 would silently drop the delivery guarantee.
+bool MQTTModule::canEverSend(const char* topic, size_t length) const {
+    if (inflight.isEnabled()) return InflightWindow::fits(strlen(topic), length);
+    return PUBLISH_OVERHEAD + strlen(topic) + length <= MQTT_BUFFER_SIZE;
+}
+
+bool MQTTModule::sendPublish(const char* topic, const uint8_t* payload, size_t length) {
+    if (!connected || streaming) return false;
+    bool sent;
+    if (!inflight.isEnabled()) {
+        sent = mqttClient.publish(topic, payload, length);
+    } else {
+        if (!inflight.hasRoom()) return false;
+        uint16_t id;
+        do {
+            id = nextPacketId();
+        } while (inflight.contains(id));
+        sent = inflight.send(netClient, topic, payload, length, id);
+    }
+    if (sent) publishesSent.add();
+    return sent;
+}
+
+bool MQTTModule::publish(const char* topic, const uint8_t* payload, size_t length) {
+    if (!canEverSend(topic, length)) {
+        publishesRejected.add();
+        Serial.printf("❌ Publish to %s too large (%u bytes, buffer %u)\n", topic, (unsigned)length, (unsigned)MQTT_BUFFER_SIZE);
+        return false;
+    }
+    if (sendPublish(topic, payload, length)) return true;
+
+    // Disconnected or the in-flight window is full; replay once there is room
+    if (outbox.enqueue(topic, payload, length)) {
+        publishesQueued.add();
+        Serial.printf("Message queued in outbox (%lu pending)\n", (unsigned long)outbox.getDepth());
+    }
+    return false;
+}
+
+bool MQTTModule::beginPublish(const char* topic, size_t length) {
+    if (!connected || streaming) return false;
+    if (!mqttClient.beginPublish(topic, length, false)) return false;
+    streaming = true;
+    streamRemaining = length;
+    return true;
+}
+
+size_t MQTTModule::write(const uint8_t* data, size_t length) {
+    if (!streaming) return 0;
+    if (length > streamRemaining) length = streamRemaining;  // Never run past the announced length
+    size_t written = mqttClient.write(data, length);
+    streamRemaining -= written;
+    return written;
+}
+
+bool MQTTModule::endPublish() {
+    if (!streaming) return false;
+    streaming = false;
+    if (streamRemaining > 0) {
+        // The broker is still waiting for payload bytes; the session cannot be recovered
+        Serial.printf("❌ Streamed publish ended %u bytes short\n", (unsigned)streamRemaining);
+        handleConnectionLost();
+        return false;
+    }
+    return mqttClient.endPublish();
+}
+
+bool MQTTModule::publishStream(const char* topic, Stream& source, size_t length) {
+    if (!beginPublish(topic, length)) return false;
+
+    uint8_t chunk[MQTT_STREAM_CHUNK];
+    while (streamRemaining > 0) {
+        size_t wanted = streamRemaining < sizeof(chunk) ? streamRemaining : sizeof(chunk);
+        size_t read = source.readBytes(chunk, wanted);
+        if (read == 0 || write(chunk, read) != read) break;
+    }
+    return endPublish();
+}
+
+bool MQTTModule::publishFile(const char* topic, const char* path) {
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        Serial.printf("❌ Cannot open %s for publishing\n", path);
+        return false;
+    }
+    size_t size = file.size();
+    bool sent = publishStream(topic, file, size);
+    file.close();
+    if (sent) {
+        Serial.printf("✅ Published %s (%u bytes)\n", path, (unsigned)size);
+    } else {
+        Serial.printf("❌ Failed to publish %s\n", path);
+    }
+    return sent;
+}
+
+uint16_t MQTTModule::nextPacketId() {
+    if (++packetId == 0) packetId = 1;  // 0 is not a valid packet identifier
+    return packetId;
+}
+
+// PubSubClient sends one SUBSCRIBE per topic, so the packet is written directly.
+// PubSubClient neither sees the write nor reads the SUBACK: the inbound scanner
+// reports the SUBACK through onSuback(), and since lastOutActivity is not
+// updated, PubSubClient may send its PINGREQ earlier than needed, never later.
+// QoS 1 publishes written by InflightWindow behave the same way.
+bool MQTTModule::sendSubscribe(size_t first, size_t count) {
+    if (!connected || count == 0) return false;
+
+    const size_t HEADER_ROOM = 5;  // Type byte plus up to four remaining-length bytes
+    uint8_t packet[MQTT_BUFFER_SIZE];
+    size_t length = HEADER_ROOM;
+    uint16_t id = nextPacketId();
+    packet[length++] = id >> 8;
+    packet[length++] = id & 0xFF;
+    for (size_t i = first; i < first + count; i++) {
+        const char* filter = subscriptions.getFilter(i);
+        size_t filterLength = strlen(filter);
+        if (length + filterLength + 3 > sizeof(packet)) {
+            Serial.println("❌ SUBSCRIBE packet exceeds buffer");
+            return false;
+        }
+        packet[length++] = filterLength >> 8;
+        packet[length++] = filterLength & 0xFF;
+        memcpy(packet + length, filter, filterLength);
+        length += filterLength;
+        packet[length++] = 0;  // Requested QoS
+    }
+
+    // Fixed header goes directly in front of the body
+    uint8_t header[HEADER_ROOM];
+    size_t headerLength = 0;
+    size_t remaining = length - HEADER_ROOM;
+    header[headerLength++] = 0x82;
+    do {
+        uint8_t digit = remaining % 128;
+        remaining /= 128;
+        if (remaining > 0) digit |= 0x80;
+        header[headerLength++] = digit;
+    } while (remaining > 0);
+
+    uint8_t* start = packet + HEADER_ROOM - headerLength;
+    memcpy(start, header, headerLength);
+    size_t total = length - HEADER_ROOM + headerLength;
+    if (netClient.write(start, total) != total) return false;
+    if (!subackWaiting) subackSentAt = millis();
+    subackWaiting = true;
+    subackPending = id;
+    return true;
+}
+
+bool MQTTModule::subscribe(const char* filter, MQTTMessageCallback handler) {
+    size_t before = subscriptions.size();
+    if (!subscriptions.add(filter, handler)) return false;
+    if (subscriptions.size() == before || !connected) return true;  // Sent with the rest on connect
+    return sendSubscribe(before, 1);
 }
 
 bool MQTTModule::subscribe(const char* topic) {
-    if (!connected) return false;
-    return mqttClient->subscribe(topic);
+    return subscribe(topic, commandCallback);
 }
 
 void MQTTModule::callback(char* topic, byte* payload, unsigned int length) {
-    // Handle incoming messages
-    Serial.print("MQTT Message arrived [");
-    Serial.print(topic);
-    Serial.print("] ");
-    for (int i = 0; i < length; i++) {
-        Serial.print((char)payload[i]);
-    }
-    Serial.println();
-
-    // Debug: Print configured command topic
-    Serial.print("Configured command topic: ");
-    Serial.println(commandTopic);
-
-    // Handle commands
-    String topicStr = String(topic);
-    String message = "";
-    for (int i = 0; i < length; i++) {
-        message += (char)payload[i];
-    }
-
-    Serial.print("Comparing '");
-    Serial.print(topicStr);
-    Serial.print("' with '");
-    Serial.print(commandTopic);
-    Serial.println("'");
-
-    if (topicStr == commandTopic) {
-        Serial.print("✅ Received command: ");
-        Serial.println(message);
-        // Handle command here
-    } else {
-        Serial.println("❌ Topic does not match command topic");
+    // payload points into PubSubClient's buffer and is only valid during this call
+    if (subscriptions.dispatch(topic, payload, length) == 0) {
+        Serial.printf("Ignoring message on %s (%u bytes)\n", topic, length);
     }
 }
 
 // Convenience methods for configured topics
-bool MQTTModule::publishStatus(const String& message) {
+bool MQTTModule::publishStatus(const char* payload, size_t length) {
     if (statusTopic.isEmpty()) return false;
-    return publish(statusTopic.c_str(), message.c_str());
+    return publish(statusTopic.c_str(), (const uint8_t*)payload, length);
 }
 
-bool MQTTModule::publishSensor(const String& sensorData) {
+bool MQTTModule::publishSensor(const char* payload, size_t length) {
     if (sensorTopic.isEmpty()) return false;
-    return publish(sensorTopic.c_str(), sensorData.c_str());
+    return publish(sensorTopic.c_str(), (const uint8_t*)payload, length);
 }
 
 bool MQTTModule::publishHeartbeat() {
-    if (heartbeatTopic.isEmpty()) return false;
-    String heartbeatMsg = "{\"timestamp\":" + String(millis()) + ",\"status\":\"online\"}";
-    return publish(heartbeatTopic.c_str(), heartbeatMsg.c_str());
+    if (heartbeatTopic.isEmpty() || !connected) return false;  // Stale heartbeats are not worth storing
+
+    char buffer[64];
+    PayloadWriter heartbeat(buffer, sizeof(buffer), heartbeatFormat);
+    if (!formatHeartbeat(heartbeat, millis())) return false;
+    return mqttClient.publish(heartbeatTopic.c_str(), (const uint8_t*)heartbeat.c_str(), heartbeat.size());
+}
+
+bool MQTTModule::formatHeartbeat(PayloadWriter& writer, unsigned long timestamp) {
+    writer.beginObject();
+    writer.add("timestamp", timestamp);
+    writer.add("status", "online");
+    writer.endObject();
+    return writer.ok();
+}
+
+void MQTTModule::registerMetrics(MetricsRegistry& registry) {
+    registry.add("published", publishesSent);
+    registry.add("queued", publishesQueued);
+    registry.add("rejected", publishesRejected);
+    registry.add("connectFailures", connectFailures);
+    registry.add("ackMs", inflight.getAckHistogram());
+    registry.add("tlsMs", handshakeTime);
+    static const char* const reconnectNames[] = { "reconnectEthMs", "reconnectWiFiMs", "reconnectLteMs" };
+    for (int i = ETHERNET; i <= LTE; i++) {
+        if (netController->isLinkEnabled((NetInterface)i)) {
+            registry.add(reconnectNames[i], reconnectTime[i]);
+        }
+    }
+}
+
+bool MQTTModule::publishMetrics(const char* payload, size_t length) {
+    // A snapshot is only worth anything while it is current
+    if (metricsTopic.isEmpty() || !connected) return false;
+    return sendPublish(metricsTopic.c_str(), (const uint8_t*)payload, length);
 }
 
 bool MQTTModule::subscribeToCommands() {
-    if (commandTopic.isEmpty()) return false;
-    return subscribe(commandTopic.c_str());
+    if (!commandTopic.isEmpty()) {
+        subscriptions.add(commandTopic.c_str(), commandCallback);
+    }
+    return sendSubscribe(0, subscriptions.size());
 }
\ No newline at end of file
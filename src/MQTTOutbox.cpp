@@ -0,0 +1,285 @@
+#include "MQTTOutbox.h"
+
+#define OUTBOX_DIR       "/outbox"
+#define OUTBOX_HEAD_FILE "/outbox/head"
+
+MQTTOutbox::MQTTOutbox() :
+    enabled(false),
+    maxBytes(0),
+    segmentSize(0),
+    headSegment(0),
+    headOffset(0),
+    tailSegment(0),
+    tailSize(0),
+    depth(0),
+    bytesStored(0),
+    dropped(0)
+{
+}
+
+String MQTTOutbox::segmentPath(uint32_t segment) {
+    char path[32];
+    snprintf(path, sizeof(path), OUTBOX_DIR "/%08lu.seg", (unsigned long)segment);
+    return String(path);
+}
+
+bool MQTTOutbox::begin(size_t maxBytes, size_t segmentSize) {
+    enabled = false;
+    if (segmentSize < sizeof(RecordHeader) + 1 || maxBytes < segmentSize * 2) {
+        Serial.println("❌ Outbox size limits invalid, store-and-forward disabled");
+        return false;
+    }
+    if (!LittleFS.begin(false)) {  // false = don't format if mount fails
+        Serial.println("LittleFS not initialized for outbox");
+        return false;
+    }
+    if (!LittleFS.exists(OUTBOX_DIR) && !LittleFS.mkdir(OUTBOX_DIR)) {
+        Serial.println("❌ Failed to create outbox directory");
+        return false;
+    }
+
+    this->maxBytes = maxBytes;
+    this->segmentSize = segmentSize;
+
+    // Find the range of segments left over from before the last reset
+    bool found = false;
+    uint32_t lowest = 0;
+    uint32_t highest = 0;
+    uint32_t totalSize = 0;
+    File dir = LittleFS.open(OUTBOX_DIR);
+    File entry = dir.openNextFile();
+    while (entry) {
+        const char* name = entry.name();
+        const char* dot = strrchr(name, '.');
+        if (!entry.isDirectory() && dot && strcmp(dot, ".seg") == 0) {
+            uint32_t segment = strtoul(name, nullptr, 10);
+            if (!found || segment < lowest) lowest = segment;
+            if (!found || segment > highest) highest = segment;
+            totalSize += entry.size();
+            found = true;
+        }
+        entry.close();
+        entry = dir.openNextFile();
+    }
+    dir.close();
+
+    headSegment = lowest;
+    tailSegment = highest;
+    headOffset = 0;
+    tailSize = 0;
+    depth = 0;
+    bytesStored = 0;
+
+    if (found) {
+        loadHead();
+        File tail = LittleFS.open(segmentPath(tailSegment), "r");
+        if (tail) {
+            tailSize = tail.size();
+            tail.close();
+        }
+        for (uint32_t segment = headSegment; segment <= tailSegment; segment++) {
+            depth += countRecords(segment, segment == headSegment ? headOffset : 0);
+        }
+        bytesStored = totalSize - headOffset;
+    }
+
+    enabled = true;
+    Serial.printf("Outbox ready: %lu messages (%lu bytes) pending\n", (unsigned long)depth, (unsigned long)bytesStored);
+    return true;
+}
+
+void MQTTOutbox::loadHead() {
+    File file = LittleFS.open(OUTBOX_HEAD_FILE, "r");
+    if (!file) return;
+    uint32_t saved[2];
+    if (file.read((uint8_t*)saved, sizeof(saved)) == sizeof(saved) && saved[0] == headSegment) {
+        headOffset = saved[1];
+    }
+    file.close();
+}
+
+void MQTTOutbox::saveHead() {
+    File file = LittleFS.open(OUTBOX_HEAD_FILE, "w");
+    if (!file) return;
+    uint32_t saved[2] = { headSegment, headOffset };
+    file.write((const uint8_t*)saved, sizeof(saved));
+    file.close();
+}
+
+uint32_t MQTTOutbox::countRecords(uint32_t segment, uint32_t offset) {
+    File file = LittleFS.open(segmentPath(segment), "r");
+    if (!file) return 0;
+
+    uint32_t count = 0;
+    size_t size = file.size();
+    file.seek(offset);
+    RecordHeader header;
+    while (offset + sizeof(header) <= size) {
+        if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) || header.magic != RECORD_MAGIC) break;
+        offset += sizeof(header) + header.topicLength + header.payloadLength;
+        if (offset > size) break;  // Truncated by a reset mid-write
+        file.seek(offset);
+        count++;
+    }
+    file.close();
+    return count;
+}
+
+void MQTTOutbox::dropHeadSegment() {
+    uint32_t lost = countRecords(headSegment, headOffset);
+    File file = LittleFS.open(segmentPath(headSegment), "r");
+    uint32_t remaining = file ? file.size() - headOffset : 0;
+    if (file) file.close();
+
+    LittleFS.remove(segmentPath(headSegment));
+    dropped += lost;
+    depth -= lost;
+    bytesStored -= remaining;
+
+    if (headSegment == tailSegment) {
+        tailSegment++;
+        tailSize = 0;
+    }
+    headSegment++;
+    headOffset = 0;
+    saveHead();
+}
+
+bool MQTTOutbox::enqueue(const char* topic, const uint8_t* payload, size_t length) {
+    if (!enabled) return false;
+
+    size_t topicLength = strlen(topic);
+    size_t recordSize = sizeof(RecordHeader) + topicLength + length;
+    if (topicLength > MAX_TOPIC_LENGTH || length > MAX_PAYLOAD_LENGTH || recordSize > segmentSize) {
+        dropped++;
+        return false;
+    }
+
+    // Make room by discarding the oldest data rather than the newest
+    while (depth > 0 && bytesStored + recordSize > maxBytes) {
+        dropHeadSegment();
+    }
+
+    if (tailSize + recordSize > segmentSize) {
+        tailSegment++;
+        tailSize = 0;
+    }
+
+    File file = LittleFS.open(segmentPath(tailSegment), "a");
+    if (!file) {
+        dropped++;
+        return false;
+    }
+    RecordHeader header = { RECORD_MAGIC, 0, (uint16_t)topicLength, (uint16_t)length };
+    size_t written = file.write((const uint8_t*)&header, sizeof(header));
+    written += file.write((const uint8_t*)topic, topicLength);
+    written += file.write(payload, length);
+    file.close();
+
+    tailSize += written;
+    bytesStored += written;
+    if (written != recordSize) {
+        // Readers stop at a partial record, so never append after one
+        tailSegment++;
+        tailSize = 0;
+        dropped++;
+        return false;
+    }
+    depth++;
+    return true;
+}
+
+void MQTTOutbox::advanceHead() {
+    if (headSegment == tailSegment) {
+        // Everything has been sent; start the next append in a fresh segment
+        LittleFS.remove(segmentPath(headSegment));
+        headSegment++;
+        tailSegment = headSegment;
+        tailSize = 0;
+    } else {
+        LittleFS.remove(segmentPath(headSegment));
+        headSegment++;
+    }
+    headOffset = 0;
+}
+
+size_t MQTTOutbox::replay(size_t maxMessages, const ReplaySink& sink) {
+    if (!enabled || depth == 0) return 0;
+
+    size_t sent = 0;
+    size_t rejected = 0;
+    while (sent + rejected < maxMessages && depth > 0) {
+        File file = LittleFS.open(segmentPath(headSegment), "r");
+        if (!file) {
+            if (headSegment == tailSegment) {
+                // Bookkeeping no longer matches the filesystem; start over
+                depth = 0;
+                bytesStored = 0;
+                break;
+            }
+            advanceHead();
+            continue;
+        }
+
+        size_t size = file.size();
+        file.seek(headOffset);
+        bool stalled = false;
+        while (sent + rejected < maxMessages && headOffset + sizeof(RecordHeader) <= size) {
+            RecordHeader header;
+            if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) || header.magic != RECORD_MAGIC) break;
+            if (header.topicLength > MAX_TOPIC_LENGTH || header.payloadLength > MAX_PAYLOAD_LENGTH) break;
+            size_t recordSize = sizeof(header) + header.topicLength + header.payloadLength;
+            if (headOffset + recordSize > size) break;
+
+            file.read((uint8_t*)topicBuffer, header.topicLength);
+            topicBuffer[header.topicLength] = '\0';
+            file.read(payloadBuffer, header.payloadLength);
+
+            ReplayResult result = sink(topicBuffer, payloadBuffer, header.payloadLength);
+            if (result == REPLAY_RETRY) {
+                stalled = true;
+                break;
+            }
+            // A record the sink can never take would otherwise block everything behind it
+            if (result == REPLAY_REJECTED) {
+                rejected++;
+                dropped++;
+            } else {
+                sent++;
+            }
+            headOffset += recordSize;
+            bytesStored -= recordSize;
+            depth--;
+        }
+        bool exhausted = !stalled && headOffset + sizeof(RecordHeader) > size;
+        bool corrupt = !stalled && !exhausted && sent + rejected < maxMessages;
+        file.close();
+
+        if (stalled) break;
+        if (exhausted || corrupt) {
+            // Skip any torn tail of the segment left by a reset mid-write
+            bytesStored -= size - headOffset;
+            if (headSegment == tailSegment && !corrupt && depth > 0) break;
+            advanceHead();
+        }
+    }
+
+    // Only records moving the head need a flash write; a fully sent segment is
+    // deleted, and loadHead() ignores an offset saved for a segment that is gone
+    if (sent + rejected > 0) saveHead();
+    return sent;
+}
+
+void MQTTOutbox::clear() {
+    if (!enabled) return;
+    for (uint32_t segment = headSegment; segment <= tailSegment; segment++) {
+        LittleFS.remove(segmentPath(segment));
+    }
+    LittleFS.remove(OUTBOX_HEAD_FILE);
+    headSegment = tailSegment + 1;
+    tailSegment = headSegment;
+    headOffset = 0;
+    tailSize = 0;
+    depth = 0;
+    bytesStored = 0;
+}
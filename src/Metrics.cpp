@@ -0,0 +1,66 @@
+#include "Metrics.h"
+#include <Arduino.h>
+
+const uint32_t LATENCY_MS_BOUNDS[8] = { 10, 25, 50, 100, 250, 500, 1000, 5000 };
+const uint32_t RECONNECT_MS_BOUNDS[6] = { 500, 1000, 2000, 5000, 15000, 60000 };
+const uint32_t LOOP_US_BOUNDS[6] = { 100, 500, 1000, 5000, 20000, 100000 };
+
+Histogram::Histogram(const uint32_t* bounds, uint8_t boundCount) :
+    bounds(bounds),
+    boundCount(boundCount < MAX_BOUNDS ? boundCount : MAX_BOUNDS),
+    count(0),
+    sum(0),
+    max(0)
+{
+    for (std::atomic<uint32_t>& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::snapshot(PayloadWriter& writer, const char* name) {
+    writer.beginObject(name);
+    writer.add("n", (unsigned long)count.exchange(0, std::memory_order_relaxed));
+    writer.add("sum", (unsigned long)sum.exchange(0, std::memory_order_relaxed));
+    writer.add("max", (unsigned long)max.exchange(0, std::memory_order_relaxed));
+    writer.beginArray("b");
+    for (uint8_t i = 0; i <= boundCount; i++) {
+        writer.add((unsigned long)buckets[i].exchange(0, std::memory_order_relaxed));
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+MetricsRegistry::MetricsRegistry() : count(0) {}
+
+bool MetricsRegistry::add(const char* name, Kind kind, void* instrument) {
+    if (count >= MAX_METRICS) {
+        Serial.printf("❌ Metrics registry full, dropping %s\n", name);
+        return false;
+    }
+    entries[count].name = name;
+    entries[count].kind = kind;
+    entries[count].instrument = instrument;
+    count++;
+    return true;
+}
+
+bool MetricsRegistry::snapshot(PayloadWriter& writer) {
+    writer.beginObject();
+    writer.add("uptime", millis() / 1000);
+    for (size_t i = 0; i < count; i++) {
+        const Entry& entry = entries[i];
+        switch (entry.kind) {
+            case METRIC_COUNTER:
+                writer.add(entry.name, (unsigned long)((Counter*)entry.instrument)->get());
+                break;
+            case METRIC_GAUGE:
+                writer.add(entry.name, (long)((Gauge*)entry.instrument)->get());
+                break;
+            case METRIC_HISTOGRAM:
+                ((Histogram*)entry.instrument)->snapshot(writer, entry.name);
+                break;
+        }
+    }
+    writer.endObject();
+    return writer.ok();
+}
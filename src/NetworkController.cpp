@@ -1,245 +1,445 @@
 #include "NetworkController.h"
-#include "WiFiModule.h"
-#include "EthernetModule.h"
-#include "LTEModule.h"
-#include "board.h"
-
-NetworkController* NetworkController::instance = nullptr;
+#include <WiFi.h>
+#include <esp_netif.h>
+#include <esp_random.h>
+#include <lwip/sockets.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
 
 NetworkController::NetworkController() :
-    currentInterface(ETHERNET),
+    currentInterface(WIFI),
     state(DISCONNECTED),
     onConnectedCallback(nullptr),
     onDisconnectedCallback(nullptr),
-    wifi(new WiFiModule()),
-    ethernet(new EthernetModule()),
-    lte(nullptr), // Initialize later with serial
-    retryCount(0),
-    lastRetryTime(0)
+    priorityOrder{ WIFI },
+    priorityCount(1),
+    probePort(0),
+    probeInterval(30000),
+    probeTimeout(3000),
+    weights{ 1.0f, 1.0f, 1.0f, 5.0f },
+    hysteresis(10),
+    holdTime(60000),
+    lastSwitch(0),
+    linkLostAt(0),
+    failoverCount(0),
+    lastFailoverMs(0)
 {
+    for (Link& link : links) {
+        link.up = false;
+        link.reachable = false;
+        link.probeSocket = -1;
+        link.probeStarted = 0;
+        link.lastProbe = 0;
+        link.retry.configure(2000, 60000, esp_random());
+        link.probes = 0;
+        link.rttMs = 0;
+        link.loss = 0;
+        link.signal = 0;
+        link.score = 0;
+    }
 }
 
 NetworkController::~NetworkController() {
-    delete wifi;
-    delete ethernet;
-    delete lte;
+    for (Link& link : links) {
+        if (link.probeSocket >= 0) close(link.probeSocket);
+    }
 }
 
 void NetworkController::begin() {
-    instance = this;
-    WiFi.onEvent(networkEventHandler);
-
-    // Skip LTE initialization since this ESP32 has no LTE hardware
-    // HardwareSerial* lteSerial = new HardwareSerial(LTE_SERIAL_NUM);
-    // lteSerial->begin(LTE_SERIAL_BAUD, SERIAL_8N1, LTE_RX_PIN, LTE_TX_PIN);
-    // lte = new LTEModule(lteSerial);
-    lte = nullptr;  // Set to null to prevent crashes
-    Serial.println("LTE hardware initialization skipped");
+#if BOARD_HAS_LTE
+    lte.begin();  // Starts the modem; setLTEAPN() must have run first
+#endif
 
-    // Set default credentials (user should set via methods)
-    // wifi->setCredentials("SSID", "PASS");
-    // ethernet->setConfig(...);
-    // lte->setAPN("APN");
-
-    // Start with first priority
-    attemptConnection(WIFI);
-    // attemptConnection(priorityOrder[0]);
+    // Bring every configured interface up in parallel; update() picks the best one
+    unsigned long now = millis();
+    for (size_t i = 0; i < priorityCount; i++) {
+        NetInterface interface = priorityOrder[i];
+        linkFor(interface).retry.schedule(now);
+        bringUp(interface);
+    }
 }
 
 void NetworkController::update() {
-    checkConnection();
+    unsigned long now = millis();
 
-    if (state == DISCONNECTED) {
-        if (millis() - lastRetryTime > retryDelay) {
-            triggerFailover();
-        }
-    } else if (state == CONNECTED) {
-        // Check for higher priority interfaces that are available
-        size_t currentIndex = 0;
-        for (size_t i = 0; i < priorityOrder.size(); i++) {
-            if (priorityOrder[i] == currentInterface) {
-                currentIndex = i;
-                break;
-            }
-        }
-        for (size_t i = 0; i < currentIndex; i++) {
-            NetInterface higher = priorityOrder[i];
-            bool isHigherConnected = false;
-            switch (higher) {
-                case ETHERNET:
-                    isHigherConnected = ethernet->isConnected();
-                    break;
-                case WIFI:
-                    isHigherConnected = wifi->isConnected();
-                    break;
-                case LTE:
-                    isHigherConnected = lte && lte->isConnected();
-                    break;
+    for (size_t i = 0; i < priorityCount; i++) {
+        NetInterface interface = priorityOrder[i];
+        Link& link = linkFor(interface);
+        bool wasUp = link.up;
+        link.up = isLinkUp(interface);
+
+        if (!link.up) {
+            if (wasUp) {
+                Serial.printf("%s link down\n", interfaceName(interface));
+                link.retry.reset();
             }
-            if (isHigherConnected) {
-                // Switch to higher priority interface
-                currentInterface = higher;
-                if (onConnectedCallback) onConnectedCallback(higher);
-                break; // Switch to the highest available
+            if (link.probeSocket >= 0) finishProbe(interface, false, now);
+            link.reachable = false;
+            link.probes = 0;
+            link.score = 0;
+            if (link.retry.isDue(now)) {
+                link.retry.schedule(now);
+                if (link.retry.getFailures() > 1) {
+                    Serial.printf("%s bring-up attempt %lu, next in %lu ms\n", interfaceName(interface),
+                                  (unsigned long)link.retry.getFailures(), (unsigned long)link.retry.getDelay());
+                }
+                bringUp(interface);
             }
+            continue;
         }
+        if (!wasUp) {
+            Serial.printf("%s link up\n", interfaceName(interface));
+            link.retry.reset();
+            link.lastProbe = now - probeInterval;  // Probe right away
+            link.signal = readSignal(interface);
+            updateScore(interface);
+        }
+        stepProbe(interface, now);
+    }
+
+    if (state == CONNECTED && !linkFor(currentInterface).up) {
+        state = DISCONNECTED;
+        linkLostAt = now;
+        if (onDisconnectedCallback) onDisconnectedCallback(currentInterface);
+    }
+
+    NetInterface best;
+    if (state == CONNECTED) {
+        // Only move a working session for a clearly better link, and not too often
+        if (now - lastSwitch < holdTime) return;
+        if (findBest(best, true) && best != currentInterface &&
+            linkFor(best).score >= linkFor(currentInterface).score + hysteresis) {
+            switchTo(best, now);
+        }
+        return;
+    }
+
+    // Disconnected: prefer a verified standby, but any live link beats none
+    if (findBest(best, true) || findBest(best, false)) {
+        switchTo(best, now);
     }
 }
 
-void NetworkController::setOnConnectedCallback(NetworkEventCallback cb) {
-    onConnectedCallback = cb;
+bool NetworkController::findBest(NetInterface& best, bool verifiedOnly) const {
+    bool found = false;
+    for (size_t i = 0; i < priorityCount; i++) {
+        NetInterface interface = priorityOrder[i];
+        const Link& link = linkFor(interface);
+        if (!link.up || (verifiedOnly && !link.reachable)) continue;
+        // Ties go to the interface listed first
+        if (!found || link.score > linkFor(best).score) {
+            best = interface;
+            found = true;
+        }
+    }
+    return found;
 }
 
-void NetworkController::setOnDisconnectedCallback(NetworkEventCallback cb) {
-    onDisconnectedCallback = cb;
+void NetworkController::switchTo(NetInterface interface, unsigned long now) {
+    NetInterface previous = currentInterface;
+    bool wasConnected = state == CONNECTED;
+    makeDefault(interface);
+    currentInterface = interface;
+    state = CONNECTED;
+    lastSwitch = now;
+
+    if (!wasConnected && linkLostAt != 0) {
+        lastFailoverMs = now - linkLostAt;
+        failoverCount++;
+        linkLostAt = 0;
+        Serial.printf("✅ Failed over from %s to %s in %lu ms\n", interfaceName(previous), interfaceName(interface), (unsigned long)lastFailoverMs);
+    } else if (wasConnected) {
+        // The previous link stays up as a warm standby
+        Serial.printf("Moving traffic from %s (score %u) to %s (score %u)\n", interfaceName(previous), linkFor(previous).score,
+                      interfaceName(interface), linkFor(interface).score);
+    }
+    if (onConnectedCallback) onConnectedCallback(interface);
 }
 
-NetInterface NetworkController::getCurrentInterface() {
-    return currentInterface;
+// Interfaces that are not fitted never reach these switches: setPriority()
+// drops them, so they need no case and no run-time check
+bool NetworkController::isLinkUp(NetInterface interface) {
+    switch (interface) {
+#if BOARD_HAS_ETHERNET
+        case ETHERNET: return ethernet.isConnected();
+#endif
+#if BOARD_HAS_LTE
+        case LTE:      return lte.isConnected();
+#endif
+        default:       return wifi.isConnected();
+    }
 }
 
-NetworkState NetworkController::getState() {
-    return state;
+void NetworkController::bringUp(NetInterface interface) {
+    switch (interface) {
+#if BOARD_HAS_ETHERNET
+        case ETHERNET: ethernet.connect(); break;
+#endif
+#if BOARD_HAS_LTE
+        case LTE:      lte.connect(); break;
+#endif
+        default:       wifi.connect(); break;
+    }
 }
 
-void NetworkController::attemptConnection(NetInterface interface) {
-    state = CONNECTING;
-    bool success = false;
+void NetworkController::makeDefault(NetInterface interface) {
+    // Route new sockets (DNS, MQTT) over this interface
+    switch (interface) {
+#if BOARD_HAS_ETHERNET
+        case ETHERNET: ETH.setDefault(); break;
+#endif
+#if BOARD_HAS_LTE
+        case LTE:      PPP.setDefault(); break;
+#endif
+        default:       WiFi.STA.setDefault(); break;
+    }
+}
 
+static esp_netif_t* netifFor(NetInterface interface) {
     switch (interface) {
-        case ETHERNET:
-            success = ethernet->connect();
-            break;
-        case WIFI:
-            success = wifi->connect();
-            break;
-        case LTE:
-            success = lte && lte->connect();
-            break;
-    }
-
-    if (success) {
-        state = CONNECTED;
-        currentInterface = interface;
-        if (onConnectedCallback) onConnectedCallback(interface);
-    } else {
-        state = DISCONNECTED;
+#if BOARD_HAS_ETHERNET
+        case ETHERNET: return ETH.netif();
+#endif
+#if BOARD_HAS_LTE
+        case LTE:      return PPP.netif();
+#endif
+        default:       return WiFi.STA.netif();
     }
 }
 
-void NetworkController::checkConnection() {
-    bool isConnected = false;
+void NetworkController::stepProbe(NetInterface interface, unsigned long now) {
+    Link& link = linkFor(interface);
+    if (probePort == 0) return;
+
+    if (link.probeSocket < 0) {
+        if (now - link.lastProbe >= probeInterval) startProbe(interface, now);
+        return;
+    }
+
+    // Non-blocking connect completes when the socket becomes writable
+    fd_set writable;
+    FD_ZERO(&writable);
+    FD_SET(link.probeSocket, &writable);
+    struct timeval noWait = { 0, 0 };
+    int ready = select(link.probeSocket + 1, nullptr, &writable, nullptr, &noWait);
+    if (ready > 0) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(link.probeSocket, SOL_SOCKET, SO_ERROR, &error, &length);
+        finishProbe(interface, error == 0, now);
+    } else if (ready < 0 || now - link.probeStarted > probeTimeout) {
+        finishProbe(interface, false, now);
+    }
+}
+
+void NetworkController::startProbe(NetInterface interface, unsigned long now) {
+    Link& link = linkFor(interface);
+    link.lastProbe = now;
+
+    esp_netif_t* netif = netifFor(interface);
+    struct ifreq request;
+    memset(&request, 0, sizeof(request));
+    if (!netif || esp_netif_get_netif_impl_name(netif, request.ifr_name) != ESP_OK) return;
+
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) return;
+    // Pin the probe to this interface regardless of the default route
+    if (setsockopt(sock, SOL_SOCKET, SO_BINDTODEVICE, &request, sizeof(request)) < 0) {
+        close(sock);
+        return;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(probePort);
+    address.sin_addr.s_addr = (uint32_t)probeAddress;
+    if (connect(sock, (struct sockaddr*)&address, sizeof(address)) < 0 && errno != EINPROGRESS) {
+        close(sock);
+        link.probeSocket = -1;
+        link.probeStarted = now;
+        finishProbe(interface, false, now);
+        return;
+    }
+    link.probeSocket = sock;
+    link.probeStarted = now;
+}
+
+void NetworkController::finishProbe(NetInterface interface, bool reachable, unsigned long now) {
+    Link& link = linkFor(interface);
+    if (link.probeSocket >= 0) {
+        close(link.probeSocket);
+        link.probeSocket = -1;
+    }
+    if (reachable != link.reachable) {
+        Serial.printf("%s %s the broker\n", interfaceName(interface), reachable ? "reaches" : "cannot reach");
+    }
+    link.reachable = reachable;
+
+    // Exponentially weighted, so one bad probe moves the score but does not decide it
+    const float alpha = 0.25f;
+    float lossSample = reachable ? 0.0f : 100.0f;
+    if (reachable) {
+        float rttSample = now - link.probeStarted;
+        link.rttMs = link.probes == 0 ? rttSample : link.rttMs + alpha * (rttSample - link.rttMs);
+    }
+    link.loss = link.probes == 0 ? lossSample : link.loss + alpha * (lossSample - link.loss);
+    link.probes++;
+    link.signal = readSignal(interface);
+    updateScore(interface);
+}
 
-    switch (currentInterface) {
-        case ETHERNET:
-            isConnected = ethernet->isConnected();
-            break;
+int NetworkController::readSignal(NetInterface interface) {
+    switch (interface) {
         case WIFI:
-            isConnected = wifi->isConnected();
-            break;
-        case LTE:
-            isConnected = lte && lte->isConnected();
-            break;
+            return WiFi.RSSI();
+#if BOARD_HAS_LTE
+        case LTE: {
+            int csq = PPP.RSSI();  // 0-31, 99 when unknown
+            return csq >= 0 && csq <= 31 ? -113 + 2 * csq : 0;
+        }
+#endif
+        default:
+            return 0;
     }
+}
 
-    if (state == CONNECTED && !isConnected) {
-        state = DISCONNECTED;
-        if (onDisconnectedCallback) onDisconnectedCallback(currentInterface);
-        lastRetryTime = millis();
-        retryCount = 0;
-    }
-}
-
-void NetworkController::triggerFailover() {
-    if (retryCount < maxRetries) {
-        retryCount++;
-        attemptConnection(currentInterface);
-    } else {
-        // Switch to next interface
-        size_t currentIndex = 0;
-        for (size_t i = 0; i < priorityOrder.size(); i++) {
-            if (priorityOrder[i] == currentInterface) {
-                currentIndex = i;
-                break;
-            }
+void NetworkController::updateScore(NetInterface interface) {
+    Link& link = linkFor(interface);
+    float cost = 0;
+    for (size_t i = 0; i < priorityCount && priorityOrder[i] != interface; i++) {
+        cost += weights.priority;
+    }
+    if (link.probes > 0) {
+        cost += weights.rtt * link.rttMs / 10.0f + weights.loss * link.loss;
+    }
+    if (link.signal < -50) {
+        cost += weights.signal * (-50 - link.signal);
+    }
+    link.score = cost >= 100.0f ? 0 : (uint8_t)(100.0f - cost + 0.5f);
+}
+
+bool NetworkController::isStandbyReady(NetInterface interface) const {
+    if (!isFitted(interface)) return false;
+    const Link& link = linkFor(interface);
+    return link.up && link.reachable;
+}
+
+unsigned long NetworkController::getPollDelay(unsigned long now) const {
+    unsigned long wait = ULONG_MAX;
+    for (size_t i = 0; i < priorityCount; i++) {
+        NetInterface interface = priorityOrder[i];
+        const Link& link = linkFor(interface);
+        unsigned long due;
+        if (!link.up) {
+            due = link.retry.msUntilDue(now);
+        } else if (link.probeSocket >= 0) {
+            return PROBE_POLL;  // Probe RTT is measured in update() calls
+        } else if (probePort == 0) {
+            continue;
+        } else {
+            unsigned long elapsed = now - link.lastProbe;
+            due = elapsed >= probeInterval ? 0 : probeInterval - elapsed;
         }
-        size_t nextIndex = (currentIndex + 1) % priorityOrder.size();
-        currentInterface = priorityOrder[nextIndex];
-        retryCount = 0;
-        attemptConnection(currentInterface);
+        if (due < wait) wait = due;
     }
+    return wait;
 }
 
-void NetworkController::setWiFiCredentials(const String& ssid, const String& password) {
-    wifi->setCredentials(ssid, password);
+bool NetworkController::isLinkEnabled(NetInterface interface) const {
+    for (size_t i = 0; i < priorityCount; i++) {
+        NetInterface enabled = priorityOrder[i];
+        if (enabled == interface) return true;
+    }
+    return false;
 }
 
-void NetworkController::setWiFiStaticIP(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
-    wifi->setStaticIP(ip, gateway, subnet, dns1, dns2);
-    wifi->enableStaticIP(true);
+void NetworkController::setPriority(const NetInterface* order, size_t count) {
+    priorityCount = 0;
+    for (size_t i = 0; i < count && priorityCount < LINK_COUNT; i++) {
+        if (!isFitted(order[i])) {
+            Serial.printf("❌ %s is not fitted on this board, leaving it out\n", interfaceName(order[i]));
+            continue;
+        }
+        if (!isLinkEnabled(order[i])) priorityOrder[priorityCount++] = order[i];
+    }
+    if (priorityCount == 0) {
+        priorityOrder[priorityCount++] = WIFI;  // Always fitted
+    }
 }
 
-void NetworkController::setEthernetConfig(byte mac[6], IPAddress ip, IPAddress gateway, IPAddress subnet) {
-    ethernet->setConfig(mac, ip, gateway, subnet);
+void NetworkController::setProbeTarget(IPAddress address, uint16_t port) {
+    probeAddress = address;
+    probePort = port;
 }
 
-void NetworkController::setEthernetStaticIP(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
-    ethernet->setStaticIP(ip, gateway, subnet, dns1, dns2);
-    ethernet->enableStaticIP(true);
+void NetworkController::setProbeTiming(unsigned long interval, unsigned long timeout) {
+    probeInterval = interval;
+    probeTimeout = timeout;
 }
 
-void NetworkController::setLTEAPN(const String& apn, const String& user, const String& pass) {
-    if (lte) {
-        lte->setAPN(apn, user, pass);
-    } else {
-        Serial.println("LTE not available, skipping APN setup");
+void NetworkController::setSelection(const LinkWeights& weights, uint8_t hysteresis, unsigned long holdTime) {
+    this->weights = weights;
+    this->hysteresis = hysteresis;
+    this->holdTime = holdTime;
+}
+
+void NetworkController::setReconnect(unsigned long baseDelay, unsigned long maxDelay) {
+    for (Link& link : links) {
+        link.retry.configure(baseDelay, maxDelay, esp_random());
     }
 }
 
-void NetworkController::networkEventHandler(arduino_event_id_t event, arduino_event_info_t info) {
-    if (!instance) return;
+void NetworkController::setOnConnectedCallback(NetworkEventCallback cb) {
+    onConnectedCallback = cb;
+}
 
-    switch (event) {
-        case ARDUINO_EVENT_ETH_CONNECTED:
-            instance->state = CONNECTED;
-            instance->currentInterface = ETHERNET;
-            if (instance->onConnectedCallback) instance->onConnectedCallback(ETHERNET);
-            break;
-        case ARDUINO_EVENT_ETH_DISCONNECTED:
-            instance->state = DISCONNECTED;
-            if (instance->onDisconnectedCallback) instance->onDisconnectedCallback(ETHERNET);
-            if (instance->currentInterface == ETHERNET) {
-                instance->lastRetryTime = millis();
-                instance->retryCount = 0;
-            }
-            break;
-        case ARDUINO_EVENT_WIFI_STA_CONNECTED:
-            instance->state = CONNECTED;
-            instance->currentInterface = WIFI;
-            if (instance->onConnectedCallback) instance->onConnectedCallback(WIFI);
-            break;
-        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
-            instance->state = DISCONNECTED;
-            if (instance->onDisconnectedCallback) instance->onDisconnectedCallback(WIFI);
-            if (instance->currentInterface == WIFI) {
-                instance->lastRetryTime = millis();
-                instance->retryCount = 0;
-            }
-            break;
-        case ARDUINO_EVENT_PPP_CONNECTED:
-            instance->state = CONNECTED;
-            instance->currentInterface = LTE;
-            if (instance->onConnectedCallback) instance->onConnectedCallback(LTE);
-            break;
-        case ARDUINO_EVENT_PPP_DISCONNECTED:
-            instance->state = DISCONNECTED;
-            if (instance->onDisconnectedCallback) instance->onDisconnectedCallback(LTE);
-            if (instance->currentInterface == LTE) {
-                instance->lastRetryTime = millis();
-                instance->retryCount = 0;
-            }
-            break;
-        default:
-            break;
+void NetworkController::setOnDisconnectedCallback(NetworkEventCallback cb) {
+    onDisconnectedCallback = cb;
+}
+
+NetInterface NetworkController::getCurrentInterface() {
+    return currentInterface;
+}
+
+NetworkState NetworkController::getState() {
+    return state;
+}
+
+const char* NetworkController::interfaceName(NetInterface interface) {
+    switch (interface) {
+        case ETHERNET: return "Ethernet";
+        case WIFI:     return "WiFi";
+        case LTE:      return "LTE";
     }
-}
\ No newline at end of file
+    return "unknown";
+}
+
+bool NetworkController::setWiFiCredentials(const char* ssid, const char* password) {
+    return wifi.setCredentials(ssid, password);
+}
+
+void NetworkController::setWiFiStaticIP(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+    wifi.setStaticIP(ip, gateway, subnet, dns1, dns2);
+    wifi.enableStaticIP(true);
+}
+
+#if BOARD_HAS_ETHERNET
+void NetworkController::setEthernetConfig(byte mac[6], IPAddress ip, IPAddress gateway, IPAddress subnet) {
+    ethernet.setConfig(mac, ip, gateway, subnet);
+}
+
+void NetworkController::setEthernetStaticIP(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+    ethernet.setStaticIP(ip, gateway, subnet, dns1, dns2);
+    ethernet.enableStaticIP(true);
+}
+#endif
+
+#if BOARD_HAS_LTE
+bool NetworkController::setLTEAPN(const char* apn, const char* user, const char* pass) {
+    return lte.setAPN(apn, user, pass);
+}
+#endif
@@ -0,0 +1,316 @@
+#include "PayloadWriter.h"
+#include <math.h>
+
+PayloadWriter::PayloadWriter(char* buffer, size_t capacity, PayloadFormat format) : buffer(buffer), capacity(capacity), format(format) {
+    reset();
+}
+
+void PayloadWriter::reset() {
+    length = 0;
+    depth = 0;
+    overflow = capacity == 0;
+    if (capacity > 0) buffer[0] = '\0';
+}
+
+void PayloadWriter::put(char c) {
+    // Always keep room for the terminating NUL so c_str() stays valid
+    if (length + 1 >= capacity) {
+        overflow = true;
+        return;
+    }
+    buffer[length++] = c;
+    buffer[length] = '\0';
+}
+
+void PayloadWriter::put(const char* str, size_t len) {
+    if (length + len >= capacity) {
+        overflow = true;
+        return;
+    }
+    memcpy(buffer + length, str, len);
+    length += len;
+    buffer[length] = '\0';
+}
+
+void PayloadWriter::separator() {
+    if (format == PAYLOAD_MSGPACK) {
+        if (depth > 0) containerCount[depth - 1]++;
+        return;
+    }
+    if (length == 0) return;
+    char last = buffer[length - 1];
+    if (last != '{' && last != '[' && last != ':') put(',');
+}
+
+void PayloadWriter::key(const char* name) {
+    separator();
+    if (format == PAYLOAD_MSGPACK) {
+        packString(name);
+        return;
+    }
+    putString(name);
+    put(':');
+}
+
+void PayloadWriter::putUnsigned(unsigned long long value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    char out[20];
+    for (size_t i = 0; i < count; i++) {
+        out[i] = digits[count - 1 - i];
+    }
+    put(out, count);
+}
+
+void PayloadWriter::putInteger(long long value) {
+    if (value < 0) {
+        put('-');
+        putUnsigned(0ULL - (unsigned long long)value);
+    } else {
+        putUnsigned((unsigned long long)value);
+    }
+}
+
+void PayloadWriter::putFloat(double value, uint8_t decimals) {
+    if (isnan(value) || isinf(value)) {
+        put("null", 4);
+        return;
+    }
+    if (decimals > 6) decimals = 6;
+
+    unsigned long long scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+
+    if (value < 0) {
+        put('-');
+        value = -value;
+    }
+    unsigned long long scaled = (unsigned long long)(value * scale + 0.5);
+    putUnsigned(scaled / scale);
+    if (decimals == 0) return;
+
+    put('.');
+    unsigned long long fraction = scaled % scale;
+    for (unsigned long long digit = scale / 10; digit > 0; digit /= 10) {
+        put('0' + (fraction / digit) % 10);
+    }
+}
+
+void PayloadWriter::putString(const char* str) {
+    static const char hex[] = "0123456789abcdef";
+    put('"');
+    for (const char* p = str; *p; p++) {
+        char c = *p;
+        switch (c) {
+            case '"':  put("\\\"", 2); break;
+            case '\\': put("\\\\", 2); break;
+            case '\n': put("\\n", 2); break;
+            case '\r': put("\\r", 2); break;
+            case '\t': put("\\t", 2); break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char escaped[6] = { '\\', 'u', '0', '0', hex[(c >> 4) & 0x0F], hex[c & 0x0F] };
+                    put(escaped, sizeof(escaped));
+                } else {
+                    put(c);
+                }
+        }
+    }
+    put('"');
+}
+
+void PayloadWriter::packNumber(uint8_t marker, unsigned long long value, size_t bytes) {
+    char out[9];
+    out[0] = (char)marker;
+    for (size_t i = bytes; i > 0; i--) {
+        out[i] = (char)value;  // Big-endian after the marker
+        value >>= 8;
+    }
+    put(out, bytes + 1);
+}
+
+void PayloadWriter::packUnsigned(unsigned long long value) {
+    if (value < 0x80) put((char)value);  // positive fixint
+    else if (value <= 0xFF) packNumber(0xCC, value, 1);
+    else if (value <= 0xFFFF) packNumber(0xCD, value, 2);
+    else if (value <= 0xFFFFFFFFULL) packNumber(0xCE, value, 4);
+    else packNumber(0xCF, value, 8);
+}
+
+void PayloadWriter::packInteger(long long value) {
+    if (value >= 0) packUnsigned((unsigned long long)value);
+    else if (value >= -32) put((char)value);  // negative fixint
+    else if (value >= INT8_MIN) packNumber(0xD0, (unsigned long long)value, 1);
+    else if (value >= INT16_MIN) packNumber(0xD1, (unsigned long long)value, 2);
+    else if (value >= INT32_MIN) packNumber(0xD2, (unsigned long long)value, 4);
+    else packNumber(0xD3, (unsigned long long)value, 8);
+}
+
+void PayloadWriter::packFloat(double value) {
+    if (isnan(value) || isinf(value)) {
+        put((char)0xC0);  // nil, matching null in JSON
+        return;
+    }
+    // float32 keeps sensor precision at half the size of float64
+    float single = (float)value;
+    uint32_t bits;
+    memcpy(&bits, &single, sizeof(bits));
+    packNumber(0xCA, bits, 4);
+}
+
+void PayloadWriter::packString(const char* str) {
+    size_t len = strlen(str);
+    if (len < 32) {
+        put((char)(0xA0 | len));
+    } else if (len <= 0xFF) {
+        char header[2] = { (char)0xD9, (char)len };
+        put(header, sizeof(header));
+    } else {
+        char header[3] = { (char)0xDA, (char)(len >> 8), (char)len };
+        put(header, sizeof(header));
+    }
+    put(str, len);
+}
+
+void PayloadWriter::openContainer(uint8_t marker) {
+    if (depth >= MAX_DEPTH) {
+        overflow = true;
+        return;
+    }
+    containerStart[depth] = length;
+    containerCount[depth] = 0;
+    depth++;
+    // Reserve the 16-bit form; closeContainer() shrinks it when the count fits a fix type
+    char header[3] = { (char)marker, 0, 0 };
+    put(header, sizeof(header));
+}
+
+void PayloadWriter::closeContainer(uint8_t fixMarker, uint8_t fixLimit) {
+    if (depth == 0) return;
+    depth--;
+    if (overflow) return;
+
+    size_t start = containerStart[depth];
+    uint16_t count = containerCount[depth];
+    if (count < fixLimit) {
+        buffer[start] = (char)(fixMarker | count);
+        memmove(buffer + start + 1, buffer + start + 3, length - start - 3);
+        length -= 2;
+        buffer[length] = '\0';
+    } else {
+        buffer[start + 1] = (char)(count >> 8);
+        buffer[start + 2] = (char)count;
+    }
+}
+
+void PayloadWriter::beginObject() {
+    separator();
+    if (format == PAYLOAD_MSGPACK) openContainer(0xDE);
+    else put('{');
+}
+
+void PayloadWriter::beginObject(const char* name) {
+    key(name);
+    if (format == PAYLOAD_MSGPACK) openContainer(0xDE);
+    else put('{');
+}
+
+void PayloadWriter::endObject() {
+    if (format == PAYLOAD_MSGPACK) closeContainer(0x80, 16);
+    else put('}');
+}
+
+void PayloadWriter::beginArray(const char* name) {
+    key(name);
+    if (format == PAYLOAD_MSGPACK) openContainer(0xDC);
+    else put('[');
+}
+
+void PayloadWriter::endArray() {
+    if (format == PAYLOAD_MSGPACK) closeContainer(0x90, 16);
+    else put(']');
+}
+
+void PayloadWriter::add(const char* name, const char* value) {
+    key(name);
+    if (format == PAYLOAD_MSGPACK) packString(value);
+    else putString(value);
+}
+
+void PayloadWriter::add(const char* name, bool value) {
+    key(name);
+    if (format == PAYLOAD_MSGPACK) put((char)(value ? 0xC3 : 0xC2));
+    else if (value) put("true", 4);
+    else put("false", 5);
+}
+
+void PayloadWriter::add(const char* name, int value) {
+    key(name);
+    if (format == PAYLOAD_MSGPACK) packInteger(value);
+    else putInteger(value);
+}
+
+void PayloadWriter::add(const char* name, unsigned int value) {
+    key(name);
+    if (format == PAYLOAD_MSGPACK) packUnsigned(value);
+    else putUnsigned(value);
+}
+
+void PayloadWriter::add(const char* name, long value) {
+    key(name);
+    if (format == PAYLOAD_MSGPACK) packInteger(value);
+    else putInteger(value);
+}
+
+void PayloadWriter::add(const char* name, unsigned long value) {
+    key(name);
+    if (format == PAYLOAD_MSGPACK) packUnsigned(value);
+    else putUnsigned(value);
+}
+
+void PayloadWriter::add(const char* name, double value, uint8_t decimals) {
+    key(name);
+    if (format == PAYLOAD_MSGPACK) packFloat(value);
+    else putFloat(value, decimals);
+}
+
+void PayloadWriter::add(const char* value) {
+    separator();
+    if (format == PAYLOAD_MSGPACK) packString(value);
+    else putString(value);
+}
+
+void PayloadWriter::add(int value) {
+    separator();
+    if (format == PAYLOAD_MSGPACK) packInteger(value);
+    else putInteger(value);
+}
+
+void PayloadWriter::add(unsigned int value) {
+    separator();
+    if (format == PAYLOAD_MSGPACK) packUnsigned(value);
+    else putUnsigned(value);
+}
+
+void PayloadWriter::add(long value) {
+    separator();
+    if (format == PAYLOAD_MSGPACK) packInteger(value);
+    else putInteger(value);
+}
+
+void PayloadWriter::add(unsigned long value) {
+    separator();
+    if (format == PAYLOAD_MSGPACK) packUnsigned(value);
+    else putUnsigned(value);
+}
+
+void PayloadWriter::add(double value, uint8_t decimals) {
+    separator();
+    if (format == PAYLOAD_MSGPACK) packFloat(value);
+    else putFloat(value, decimals);
+}
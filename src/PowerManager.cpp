@@ -0,0 +1,92 @@
+#include "PowerManager.h"
+#include "NetworkController.h"
+#include <WiFi.h>
+#include <esp_pm.h>
+#include <esp_wifi.h>
+
+PowerManager::PowerManager() :
+    mode(POWER_BALANCED),
+    minCpuMhz(80),
+    maxCpuMhz(240),
+    lightSleepActive(false),
+    lightSleepSupported(true),
+    applied(false),
+    appliedInterface(WIFI),
+    maxWakeLateMs(0),
+    lastCommandMs(0),
+    maxCommandMs(0)
+{
+}
+
+void PowerManager::configure(PowerMode mode, uint16_t minCpuMhz, uint16_t maxCpuMhz) {
+    this->mode = mode;
+    this->minCpuMhz = minCpuMhz;
+    this->maxCpuMhz = maxCpuMhz < minCpuMhz ? minCpuMhz : maxCpuMhz;
+}
+
+void PowerManager::begin() {
+    // Modem sleep is required for light sleep and has to be set before it
+    switch (mode) {
+        case POWER_PERFORMANCE: WiFi.setSleep(WIFI_PS_NONE); break;
+        case POWER_BALANCED:    WiFi.setSleep(WIFI_PS_MIN_MODEM); break;
+        case POWER_LOW:         WiFi.setSleep(WIFI_PS_MAX_MODEM); break;
+    }
+    if (mode == POWER_PERFORMANCE) {
+        setCpuFrequencyMhz(maxCpuMhz);
+    } else {
+        configurePm(false);
+    }
+    Serial.printf("Power mode %s, CPU %u-%u MHz\n", modeName(mode), minCpuMhz, maxCpuMhz);
+}
+
+void PowerManager::update(NetInterface current) {
+    if (mode != POWER_LOW || !lightSleepSupported) return;
+    if (applied && current == appliedInterface) return;
+    applied = true;
+    appliedInterface = current;
+
+    bool wanted = current == WIFI;
+    if (wanted == lightSleepActive) return;
+    if (configurePm(wanted)) {
+        lightSleepActive = wanted;
+        Serial.printf("Light sleep %s on %s\n", wanted ? "enabled" : "disabled", NetworkController::interfaceName(current));
+    } else if (wanted) {
+        lightSleepSupported = false;
+        Serial.println("❌ Light sleep unsupported by this core, using modem sleep only");
+    }
+}
+
+bool PowerManager::configurePm(bool lightSleep) {
+    esp_pm_config_t config = {};
+    config.max_freq_mhz = maxCpuMhz;
+    config.min_freq_mhz = minCpuMhz;
+    config.light_sleep_enable = lightSleep;
+    esp_err_t err = esp_pm_configure(&config);
+    if (err != ESP_OK && !lightSleep) {
+        // Power management compiled out: a fixed clock is the closest we get
+        setCpuFrequencyMhz(maxCpuMhz);
+    }
+    return err == ESP_OK;
+}
+
+void PowerManager::recordWait(uint32_t requestedMs, uint32_t actualMs) {
+    if (actualMs <= requestedMs) return;
+    uint32_t late = actualMs - requestedMs;
+    if (late > maxWakeLateMs) maxWakeLateMs = late;
+}
+
+void PowerManager::recordCommand(uint32_t latencyMs) {
+    lastCommandMs.store(latencyMs, std::memory_order_relaxed);
+    if (latencyMs > maxCommandMs.load(std::memory_order_relaxed)) {
+        maxCommandMs.store(latencyMs, std::memory_order_relaxed);
+    }
+}
+
+const char* PowerManager::modeName(PowerMode mode) {
+    switch (mode) {
+        case POWER_PERFORMANCE: return "performance";
+        case POWER_BALANCED:    return "balanced";
+        case POWER_LOW:         return "low";
+        default:                return "unknown";
+    }
+}
@@ -0,0 +1,44 @@
+#include "ReportFilter.h"
+#include <math.h>
+
+ReportFilter::ReportFilter() :
+    deadband(0),
+    minInterval(0),
+    maxInterval(0),
+    lastValue(0),
+    lastReportTime(0),
+    hasReported(false),
+    reported(0),
+    suppressed(0)
+{
+}
+
+void ReportFilter::configure(float deadband, unsigned long minInterval, unsigned long maxInterval) {
+    if (maxInterval > 0 && minInterval > maxInterval) {
+        Serial.println("Report minInterval exceeds maxInterval, using maxInterval");
+        minInterval = maxInterval;
+    }
+    this->deadband = deadband < 0 ? 0 : deadband;
+    this->minInterval = minInterval;
+    this->maxInterval = maxInterval;
+    hasReported = false;
+}
+
+bool ReportFilter::wantsReport(float value, unsigned long now) const {
+    if (!isEnabled() || !hasReported) return true;
+
+    unsigned long elapsed = now - lastReportTime;
+    if (elapsed >= maxInterval) return true;
+    return elapsed >= minInterval && fabsf(value - lastValue) > deadband;
+}
+
+void ReportFilter::markReported(float value, unsigned long now) {
+    markCarried(value, now);
+    reported.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ReportFilter::markCarried(float value, unsigned long now) {
+    lastValue = value;
+    lastReportTime = now;
+    hasReported = true;
+}
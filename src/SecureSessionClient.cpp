@@ -0,0 +1,138 @@
+#include "SecureSessionClient.h"
+#include <fcntl.h>
+
+SecureSessionClient::SecureSessionClient() : hasSession(false), sessionPort(0), sessionIdLength(0), pendingPort(0), pendingOffered(false), pendingStart(0), readObserver(nullptr), readContext(nullptr) {
+    mbedtls_ssl_session_init(&session);
+    memset(&stats, 0, sizeof(stats));
+}
+
+SecureSessionClient::~SecureSessionClient() {
+    mbedtls_ssl_session_free(&session);
+}
+
+void SecureSessionClient::clearSession() {
+    mbedtls_ssl_session_free(&session);
+    mbedtls_ssl_session_init(&session);
+    hasSession = false;
+    sessionIdLength = 0;
+}
+
+void SecureSessionClient::saveSession(const char* host, uint16_t port) {
+    mbedtls_ssl_session_free(&session);
+    mbedtls_ssl_session_init(&session);
+    if (mbedtls_ssl_get_session(&sslclient->ssl_ctx, &session) != 0) {
+        clearSession();
+        return;
+    }
+    hasSession = true;
+    sessionHost.assign(host);
+    sessionPort = port;
+    sessionIdLength = session.MBEDTLS_PRIVATE(id_len);
+    memcpy(sessionId, session.MBEDTLS_PRIVATE(id), sessionIdLength);
+}
+
+void SecureSessionClient::setReadObserver(ReadObserver observer, void* context) {
+    readObserver = observer;
+    readContext = context;
+}
+
+int SecureSessionClient::read(uint8_t* buf, size_t size) {
+    int result = NetworkClientSecure::read(buf, size);
+    if (result > 0 && readObserver) readObserver(readContext, buf, result);
+    return result;
+}
+
+int SecureSessionClient::connect(const char* host, uint16_t port) {
+    IPAddress ip;
+    if (!Network.hostByName(host, ip)) {
+        return 0;
+    }
+    if (!beginConnect(ip, host, port)) {
+        return 0;
+    }
+
+    int result;
+    while ((result = handshakeStep()) == 0) {
+        if (millis() - pendingStart > _handshake_timeout) {
+            stop();
+            return 0;
+        }
+        delay(1);
+    }
+    return result > 0;
+}
+
+int SecureSessionClient::beginConnect(IPAddress ip, const char* host, uint16_t port) {
+    pendingHost.assign(host);
+    pendingPort = port;
+    pendingOffered = hasSession && sessionPort == port && !sessionHost.isEmpty() && sessionHost == host;
+    pendingStart = millis();
+
+    // Open TCP and set up mbedTLS without handshaking so the cached session can be offered first
+    setPlainStart();
+    if (!NetworkClientSecure::connect(ip, port, host, _CA_cert, _cert, _private_key)) {
+        return 0;
+    }
+    if (pendingOffered && mbedtls_ssl_set_session(&sslclient->ssl_ctx, &session) != 0) {
+        pendingOffered = false;
+    }
+    setBlocking(false);
+    return 1;
+}
+
+// start_ssl_client() leaves the socket blocking with SO_RCVTIMEO set to the
+// connection timeout, so each handshake read could wait that long. While the
+// handshake is stepped the socket is non-blocking and mbedtls_net_recv()
+// returns WANT_READ instead; NetworkClientSecure's read() and write() expect
+// a blocking socket again afterwards.
+void SecureSessionClient::setBlocking(bool blocking) {
+    int fd = sslclient->socket;
+    if (fd < 0) return;
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK);
+}
+
+int SecureSessionClient::handshakeStep() {
+    mbedtls_ssl_context* ssl = &sslclient->ssl_ctx;
+    if (!mbedtls_ssl_is_handshake_over(ssl)) {
+        // Returns WANT_READ/WANT_WRITE as soon as it would wait on the broker
+        int ret = mbedtls_ssl_handshake_step(ssl);
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) return 0;
+        if (ret != 0) {
+            // Never offer a session that may have caused the failure twice
+            if (pendingOffered) clearSession();
+            stop();
+            return -1;
+        }
+        if (!mbedtls_ssl_is_handshake_over(ssl)) return 0;
+    }
+
+    setBlocking(true);
+    _stillinPlainStart = false;
+    recordHandshake();
+    return 1;
+}
+
+void SecureSessionClient::recordHandshake() {
+    uint32_t elapsed = millis() - pendingStart;
+
+    // The broker echoes our session ID only when it accepted the resumption
+    uint8_t offeredId[32];
+    size_t offeredIdLength = pendingOffered ? sessionIdLength : 0;
+    memcpy(offeredId, sessionId, offeredIdLength);
+    saveSession(pendingHost.c_str(), pendingPort);
+    bool resumed = offeredIdLength > 0 && offeredIdLength == sessionIdLength &&
+                   memcmp(offeredId, sessionId, sessionIdLength) == 0;
+
+    if (resumed) {
+        stats.resumed++;
+        stats.lastResumedMs = elapsed;
+        stats.totalResumedMs += elapsed;
+        Serial.printf("TLS session resumed in %lu ms\n", (unsigned long)elapsed);
+    } else {
+        stats.full++;
+        stats.lastFullMs = elapsed;
+        stats.totalFullMs += elapsed;
+        Serial.printf("TLS full handshake in %lu ms\n", (unsigned long)elapsed);
+    }
+}
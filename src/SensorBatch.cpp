@@ -0,0 +1,65 @@
+#include "SensorBatch.h"
+#include <math.h>
+
+SensorBatch::SensorBatch() : count(0), limit(1), maxAge(0) {}
+
+void SensorBatch::configure(size_t size, unsigned long maxAge) {
+    if (size > MAX_SAMPLES) {
+        Serial.printf("Batch size %u exceeds %u, clamping\n", (unsigned)size, (unsigned)MAX_SAMPLES);
+        size = MAX_SAMPLES;
+    }
+    limit = size > 0 ? size : 1;
+    this->maxAge = maxAge;
+    count = 0;
+}
+
+void SensorBatch::add(unsigned long timestamp, float temperature, float humidity) {
+    if (count >= limit) return;  // Caller flushes on isDue(); never overwrite
+    Sample& sample = samples[count++];
+    sample.timestamp = timestamp;
+    sample.temperature = (int16_t)lroundf(temperature * SCALE);
+    sample.humidity = (int16_t)lroundf(humidity * SCALE);
+}
+
+bool SensorBatch::isDue(unsigned long now) const {
+    if (count == 0) return false;
+    return count >= limit || now - samples[0].timestamp >= maxAge;
+}
+
+bool SensorBatch::encode(PayloadWriter& writer) const {
+    if (count == 0) return false;
+    writer.beginObject();
+    writer.add("n", (unsigned int)count);
+    writer.add("scale", SCALE);
+
+    writer.beginArray("t");
+    writer.add((unsigned long)samples[0].timestamp);
+    for (size_t i = 1; i < count; i++) {
+        writer.add((unsigned long)(samples[i].timestamp - samples[i - 1].timestamp));
+    }
+    writer.endArray();
+
+    writer.beginArray("temperature");
+    for (size_t i = 0; i < count; i++) {
+        writer.add(i == 0 ? (int)samples[0].temperature : samples[i].temperature - samples[i - 1].temperature);
+    }
+    writer.endArray();
+
+    writer.beginArray("humidity");
+    for (size_t i = 0; i < count; i++) {
+        writer.add(i == 0 ? (int)samples[0].humidity : samples[i].humidity - samples[i - 1].humidity);
+    }
+    writer.endArray();
+
+    writer.endObject();
+    return writer.ok();
+}
+
+bool SensorBatch::encodeReading(PayloadWriter& writer, unsigned long timestamp, float temperature, float humidity) {
+    writer.beginObject();
+    writer.add("temperature", temperature);
+    writer.add("humidity", humidity);
+    writer.add("timestamp", timestamp);
+    writer.endObject();
+    return writer.ok();
+}
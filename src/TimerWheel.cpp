@@ -0,0 +1,128 @@
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel() : currentTick(0), lastMs(0) {
+    for (Timer& timer : timers) {
+        timer.used = false;
+        timer.next = -1;
+    }
+    for (uint8_t level = 0; level < LEVELS; level++) {
+        for (uint8_t slot = 0; slot < SLOTS; slot++) {
+            slots[level][slot] = -1;
+        }
+    }
+}
+
+void TimerWheel::begin(uint32_t now) {
+    lastMs = now;
+}
+
+int TimerWheel::add(uint32_t periodMs, TimerCallback callback, void* context) {
+    if (!callback || periodMs < TICK_MS || periodMs > MAX_PERIOD) return -1;
+    for (size_t id = 0; id < MAX_TIMERS; id++) {
+        Timer& timer = timers[id];
+        if (timer.used) continue;
+        timer.used = true;
+        timer.callback = callback;
+        timer.context = context;
+        timer.period = periodMs / TICK_MS;
+        timer.expires = currentTick + timer.period;
+        insert(id);
+        return id;
+    }
+    return -1;
+}
+
+void TimerWheel::restart(int id) {
+    if (id < 0 || id >= (int)MAX_TIMERS || !timers[id].used) return;
+    unlink(id);
+    timers[id].expires = currentTick + timers[id].period;
+    insert(id);
+}
+
+void TimerWheel::insert(int8_t id) {
+    Timer& timer = timers[id];
+    uint32_t delta = timer.expires - currentTick;
+    uint8_t level = 0;
+    while (level < LEVELS - 1 && delta >= (1UL << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    uint8_t slot = (timer.expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+    timer.next = slots[level][slot];
+    slots[level][slot] = id;
+}
+
+void TimerWheel::unlink(int8_t id) {
+    for (uint8_t level = 0; level < LEVELS; level++) {
+        for (uint8_t slot = 0; slot < SLOTS; slot++) {
+            int8_t* link = &slots[level][slot];
+            while (*link >= 0) {
+                if (*link == id) {
+                    *link = timers[id].next;
+                    timers[id].next = -1;
+                    return;
+                }
+                link = &timers[*link].next;
+            }
+        }
+    }
+}
+
+void TimerWheel::cascade(uint8_t level) {
+    // Everything in this slot is now within reach of a lower level
+    uint8_t slot = (currentTick >> (SLOT_BITS * level)) & (SLOTS - 1);
+    int8_t id = slots[level][slot];
+    slots[level][slot] = -1;
+    while (id >= 0) {
+        int8_t next = timers[id].next;
+        insert(id);
+        id = next;
+    }
+}
+
+void TimerWheel::tick() {
+    currentTick++;
+    for (uint8_t level = LEVELS - 1; level > 0; level--) {
+        if ((currentTick & ((1UL << (SLOT_BITS * level)) - 1)) == 0) cascade(level);
+    }
+
+    uint8_t slot = currentTick & (SLOTS - 1);
+    int8_t id = slots[0][slot];
+    slots[0][slot] = -1;
+    while (id >= 0) {
+        Timer& timer = timers[id];
+        int8_t next = timer.next;
+        timer.expires = currentTick + timer.period;
+        insert(id);  // Re-armed first, so the callback may restart it
+        timer.callback(timer.context);
+        id = next;
+    }
+}
+
+void TimerWheel::advance(uint32_t now) {
+    uint32_t ticks = (now - lastMs) / TICK_MS;
+    lastMs += ticks * TICK_MS;
+    while (ticks-- > 0) {
+        tick();
+    }
+}
+
+uint32_t TimerWheel::msUntilNext(uint32_t now) const {
+    uint32_t nearest = UINT32_MAX;
+    for (const Timer& timer : timers) {
+        if (timer.used && timer.expires - currentTick < nearest) {
+            nearest = timer.expires - currentTick;
+        }
+    }
+    if (nearest == UINT32_MAX) return UINT32_MAX;
+    uint32_t elapsed = now - lastMs;  // Time since currentTick, under one tick unless advance() is late
+    uint32_t dueIn = nearest * TICK_MS;
+    return dueIn > elapsed ? dueIn - elapsed : 0;
+}
+
+size_t TimerWheel::size() const {
+    size_t count = 0;
+    for (const Timer& timer : timers) {
+        if (timer.used) count++;
+    }
+    return count;
+}
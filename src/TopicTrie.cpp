@@ -0,0 +1,137 @@
+#include "TopicTrie.h"
+
+TopicTrie::TopicTrie() {
+    clear();
+}
+
+void TopicTrie::clear() {
+    filterCount = 0;
+    nodeCount = 1;
+    nodes[0] = { 0, 0, 0, -1, -1, -1 };
+}
+
+bool TopicTrie::isValid(const char* filter) {
+    if (*filter == '\0') return false;
+    for (const char* p = filter; *p; p++) {
+        bool levelStart = p == filter || p[-1] == '/';
+        bool levelEnd = p[1] == '\0' || p[1] == '/';
+        if (*p == '+' && !(levelStart && levelEnd)) return false;
+        // '#' must be a whole level and the last one
+        if (*p == '#' && !(levelStart && p[1] == '\0')) return false;
+    }
+    return true;
+}
+
+int16_t TopicTrie::findChild(int16_t parent, const char* level, size_t length) const {
+    for (int16_t c = nodes[parent].child; c >= 0; c = nodes[c].sibling) {
+        if (nodes[c].length == length && memcmp(levelText(nodes[c]), level, length) == 0) return c;
+    }
+    return -1;
+}
+
+bool TopicTrie::add(const char* filter, MQTTMessageCallback handler) {
+    size_t filterLength = strlen(filter);
+    if (filterLength >= MAX_FILTER_LENGTH || !isValid(filter)) {
+        Serial.printf("❌ Invalid subscription filter: %s\n", filter);
+        return false;
+    }
+
+    // Walk the existing levels first so a full table never leaves a partial path behind
+    int16_t node = 0;
+    const char* level = filter;
+    while (level) {
+        const char* end = strchr(level, '/');
+        size_t length = end ? end - level : strlen(level);
+        int16_t child = findChild(node, level, length);
+        if (child < 0) break;
+        node = child;
+        level = end ? end + 1 : nullptr;
+    }
+
+    if (!level && nodes[node].filter >= 0) {
+        filters[nodes[node].filter].handler = handler;
+        return true;
+    }
+
+    size_t missing = 0;
+    for (const char* p = level; p; p = strchr(p, '/')) {
+        missing++;
+        p++;
+    }
+    if (filterCount >= MAX_FILTERS || nodeCount + missing > MAX_NODES) {
+        Serial.printf("❌ Subscription table full, cannot add %s\n", filter);
+        return false;
+    }
+
+    // New nodes reference their level text inside the stored copy
+    uint8_t owner = filterCount++;
+    memcpy(filters[owner].topic, filter, filterLength + 1);
+    filters[owner].handler = handler;
+    while (level) {
+        const char* end = strchr(level, '/');
+        size_t length = end ? end - level : strlen(level);
+        int16_t child = nodeCount++;
+        nodes[child] = { owner, (uint8_t)(level - filter), (uint8_t)length, -1, -1, nodes[node].child };
+        nodes[node].child = child;
+        node = child;
+        level = end ? end + 1 : nullptr;
+    }
+    nodes[node].filter = owner;
+    return true;
+}
+
+void TopicTrie::collect(int8_t filter, uint32_t& matches) {
+    if (filter >= 0) matches |= 1UL << filter;
+}
+
+// level is the unmatched remainder of the topic, or nullptr once every level matched
+void TopicTrie::matchNode(int16_t index, const char* level, uint32_t& matches) const {
+    if (!level) {
+        collect(nodes[index].filter, matches);
+        // "a/#" also matches "a" itself
+        for (int16_t c = nodes[index].child; c >= 0; c = nodes[c].sibling) {
+            if (nodes[c].length == 1 && *levelText(nodes[c]) == '#') collect(nodes[c].filter, matches);
+        }
+        return;
+    }
+
+    const char* end = strchr(level, '/');
+    size_t levelLength = end ? end - level : strlen(level);
+    const char* next = end ? end + 1 : nullptr;
+    // Wildcards at the first level never match $SYS-style topics
+    bool reserved = index == 0 && *level == '$';
+
+    for (int16_t c = nodes[index].child; c >= 0; c = nodes[c].sibling) {
+        const Node& child = nodes[c];
+        const char* text = levelText(child);
+        if (child.length == 1 && *text == '#') {
+            if (!reserved) collect(child.filter, matches);
+        } else if (child.length == 1 && *text == '+') {
+            if (!reserved) matchNode(c, next, matches);
+        } else if (child.length == levelLength && memcmp(text, level, levelLength) == 0) {
+            matchNode(c, next, matches);
+        }
+    }
+}
+
+size_t TopicTrie::dispatch(const char* topic, const uint8_t* payload, unsigned int length) const {
+    uint32_t matches = 0;
+    matchNode(0, topic, matches);
+
+    size_t matched = 0;
+    MQTTMessageCallback called[MAX_FILTERS];
+    size_t calledCount = 0;
+    for (size_t i = 0; i < filterCount; i++) {
+        if (!(matches & (1UL << i))) continue;
+        matched++;
+        MQTTMessageCallback handler = filters[i].handler;
+        bool seen = !handler;
+        for (size_t j = 0; j < calledCount && !seen; j++) {
+            seen = called[j] == handler;
+        }
+        if (seen) continue;
+        called[calledCount++] = handler;
+        handler(topic, payload, length);
+    }
+    return matched;
+}
@@ -0,0 +1,182 @@
+#include "Trace.h"
+#include <esp_attr.h>
+#include <esp_cpu.h>
+#include <esp_system.h>
+#include <atomic>
+#include <stdarg.h>
+
+#define TRACE_MAGIC 0x54524331  // "TRC1"
+
+static const char* const TRACE_NAMES[TRACE_POINT_COUNT] = {
+    "boot",
+    "network.update",
+    "mqtt.update",
+    "telemetry.publish",
+    "jobs",
+    "network.wait",
+    "dht.read",
+    "sensor.log",
+    "sensor.format",
+    "command",
+};
+
+struct TraceRecord {
+    uint32_t cycles;
+    uint16_t id;
+    uint8_t phase;
+    uint8_t reserved;
+};
+
+struct TraceRing {
+    uint32_t head;  // Records ever written; head % TRACE_CAPACITY is the next slot
+    TraceRecord records[TRACE_CAPACITY];
+};
+
+struct TraceBuffer {
+    uint32_t magic;
+    uint32_t bootCount;
+    uint32_t resetReason;  // How the previous boot ended
+    TraceRing rings[portNUM_PROCESSORS];
+};
+
+static_assert((TRACE_CAPACITY & (TRACE_CAPACITY - 1)) == 0, "TRACE_CAPACITY must be a power of two");
+
+// Not cleared on a software, watchdog or panic reset
+RTC_NOINIT_ATTR static TraceBuffer traceBuffer;
+static std::atomic<bool> tracePaused(false);
+
+static const char* resetReasonName(uint32_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON:   return "POWERON";
+        case ESP_RST_SW:        return "SW";
+        case ESP_RST_PANIC:     return "PANIC";
+        case ESP_RST_INT_WDT:   return "INT_WDT";
+        case ESP_RST_TASK_WDT:  return "TASK_WDT";
+        case ESP_RST_WDT:       return "WDT";
+        case ESP_RST_BROWNOUT:  return "BROWNOUT";
+        case ESP_RST_DEEPSLEEP: return "DEEPSLEEP";
+        default:                return "OTHER";
+    }
+}
+
+static inline void append(TraceRing& ring, uint32_t cycles, uint16_t id, uint8_t phase) {
+    TraceRecord& slot = ring.records[ring.head & (TRACE_CAPACITY - 1)];
+    slot.cycles = cycles;
+    slot.id = id;
+    slot.phase = phase;
+    ring.head++;
+}
+
+void Trace::begin() {
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool valid = reason != ESP_RST_POWERON && traceBuffer.magic == TRACE_MAGIC;
+    if (!valid) {
+        memset(&traceBuffer, 0, sizeof(traceBuffer));
+        traceBuffer.magic = TRACE_MAGIC;
+    }
+    traceBuffer.bootCount++;
+    traceBuffer.resetReason = reason;
+    // Marks the boot in every ring so the host script can split boots per core
+    uint32_t cycles = esp_cpu_get_cycle_count();
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        append(traceBuffer.rings[core], core == xPortGetCoreID() ? cycles : 0, TRACE_BOOT, TRACE_PHASE_INSTANT);
+    }
+
+    if (hasCrashTrace()) {
+        Serial.printf("❌ Previous boot ended with %s; trace preserved\n", resetReasonName(reason));
+    }
+}
+
+void Trace::record(uint16_t id, uint8_t phase) {
+#ifndef TRACE_DISABLED
+    if (tracePaused.load(std::memory_order_relaxed)) return;
+    uint32_t cycles = esp_cpu_get_cycle_count();
+    // Keeps a task on this core from interleaving with the slot update
+    uint32_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+    append(traceBuffer.rings[xPortGetCoreID()], cycles, id, phase);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+#endif
+}
+
+void Trace::pause(bool paused) {
+    tracePaused.store(paused, std::memory_order_relaxed);
+}
+
+bool Trace::hasCrashTrace() {
+    switch (traceBuffer.resetReason) {
+        case ESP_RST_PANIC:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+        case ESP_RST_BROWNOUT:
+            return traceBuffer.bootCount > 1;
+        default:
+            return false;
+    }
+}
+
+// Formats into a small buffer so the output sees a few large writes, not one per line
+class TraceWriter {
+private:
+    Print& out;
+    char buffer[256];
+    size_t length;
+    size_t total;
+
+public:
+    explicit TraceWriter(Print& out) : out(out), length(0), total(0) {}
+
+    void printf(const char* format, ...) {
+        char line[64];
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        if (n <= 0) return;
+        if ((size_t)n >= sizeof(line)) n = sizeof(line) - 1;
+        if (length + n > sizeof(buffer)) flush();
+        memcpy(buffer + length, line, n);
+        length += n;
+    }
+
+    size_t flush() {
+        if (length > 0) total += out.write((const uint8_t*)buffer, length);
+        length = 0;
+        return total;
+    }
+};
+
+size_t Trace::dump(Print& out) {
+    TraceWriter writer(out);
+    // The clock can change between dumpLength() and dump() under dynamic frequency
+    // scaling, so it is padded to a fixed width to keep the two lengths equal
+    writer.printf("# trace boot=%lu reset=%s cpuMHz=%03lu capacity=%u\n", (unsigned long)traceBuffer.bootCount,
+                  resetReasonName(traceBuffer.resetReason), (unsigned long)getCpuFrequencyMhz(), (unsigned)TRACE_CAPACITY);
+    for (uint16_t id = 0; id < TRACE_POINT_COUNT; id++) {
+        writer.printf("# name %u %s\n", id, TRACE_NAMES[id]);
+    }
+    writer.printf("core,cycles,id,phase\n");
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        const TraceRing& ring = traceBuffer.rings[core];
+        uint32_t count = ring.head < TRACE_CAPACITY ? ring.head : TRACE_CAPACITY;
+        for (uint32_t i = ring.head - count; i != ring.head; i++) {
+            const TraceRecord& record = ring.records[i & (TRACE_CAPACITY - 1)];
+            writer.printf("%d,%lu,%u,%c\n", core, (unsigned long)record.cycles, record.id, record.phase);
+        }
+    }
+    return writer.flush();
+}
+
+// Print that only counts, for the MQTT length prefix
+class CountingPrint : public Print {
+public:
+    size_t count = 0;
+    size_t write(uint8_t c) override { count++; return 1; }
+    size_t write(const uint8_t* data, size_t length) override { count += length; return length; }
+};
+
+size_t Trace::dumpLength() {
+    CountingPrint counter;
+    dump(counter);
+    return counter.count;
+}
@@ -0,0 +1,54 @@
+#include "WakeSignal.h"
+#include <esp_vfs_eventfd.h>
+#include <lwip/sockets.h>
+#include <unistd.h>
+
+WakeSignal::WakeSignal() : fd(-1) {}
+
+bool WakeSignal::begin() {
+    esp_vfs_eventfd_config_t config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    esp_err_t err = esp_vfs_eventfd_register(&config);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {  // Already registered is fine
+        Serial.printf("❌ eventfd registration failed: %d\n", err);
+        return false;
+    }
+    fd = eventfd(0, 0);
+    if (fd < 0) {
+        Serial.println("❌ Failed to create wake eventfd");
+        return false;
+    }
+    return true;
+}
+
+void WakeSignal::notify() {
+    if (fd < 0) return;
+    uint64_t one = 1;
+    write(fd, &one, sizeof(one));
+}
+
+bool WakeSignal::wait(int socket, uint32_t timeoutMs) {
+    if (fd < 0) {
+        // No eventfd: fall back to sleeping, which is what the loop did before
+        vTaskDelay(pdMS_TO_TICKS(timeoutMs < 10 ? timeoutMs : 10));
+        return false;
+    }
+
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(fd, &readable);
+    int maxFd = fd;
+    if (socket >= 0) {
+        FD_SET(socket, &readable);
+        if (socket > maxFd) maxFd = socket;
+    }
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+    int ready = select(maxFd + 1, &readable, nullptr, nullptr, &timeout);
+    if (ready > 0 && FD_ISSET(fd, &readable)) {
+        uint64_t count;
+        read(fd, &count, sizeof(count));  // Folds every notify() since the last wait into one wakeup
+    }
+    return ready > 0;
+}
@@ -2,9 +2,13 @@
 
 WiFiModule::WiFiModule() : connected(false), connecting(false), useStaticIP(false) {}
 
-void WiFiModule::setCredentials(const String& ssid, const String& password) {
-    this->ssid = ssid;
-    this->password = password;
+bool WiFiModule::setCredentials(const char* ssid, const char* password) {
+    if (!this->ssid.assign(ssid) || !this->password.assign(password)) {
+        Serial.printf("❌ WiFi SSID or password too long (max %u and %u chars)\n", (unsigned)SSIDString::capacity(), (unsigned)PassphraseString::capacity());
+        this->ssid.clear();
+        return false;
+    }
+    return true;
 }
 
 void WiFiModule::setStaticIP(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
@@ -44,11 +48,10 @@ void WiFiModule::disconnect() {
 }
 
 bool WiFiModule::isConnected() {
-    if (connecting) {
-        connected = (WiFi.status() == WL_CONNECTED);
-        if (connected) {
-            connecting = false;
-        }
+    // Polled every update so a dropped association is noticed without events
+    connected = (WiFi.status() == WL_CONNECTED);
+    if (connected) {
+        connecting = false;
     }
     return connected;
 }
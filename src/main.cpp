@@ -2,19 +2,90 @@
 #include <Adafruit_Sensor.h>
 #include <DHT.h>
 #include <DHT_U.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
 #include "NetworkController.h"
 #include "MQTTModule.h"
 #include "ConfigLoader.h"
+#include "PayloadWriter.h"
+#include "TaskMessages.h"
+#include "SensorBatch.h"
+#include "ReportFilter.h"
+#include "CommandRouter.h"
+#include "TimerWheel.h"
+#include "WakeSignal.h"
+#include "PowerManager.h"
+#include "Metrics.h"
+#include "Trace.h"
 
 #define DHTPIN  26     // Digital pin connected to the DHT sensor
 #define DHTTYPE DHT22   // DHT 22 (AM2302), AM2321
 
+#define NETWORK_TASK_STACK  12288
+#define SAMPLING_TASK_STACK 4096
+
 DHT_Unified dht(DHTPIN, DHTTYPE);
 uint32_t delayMS;
 sensor_t sensor;
 
-NetworkController* netManager;
-MQTTModule* mqtt;
+// Statically allocated, with their settings held inline rather than in heap Strings
+NetworkController netManager;
+MQTTModule mqtt(&netManager);
+
+// Sampling/command core <-> network core handoff
+TelemetryQueue telemetryQueue;
+CommandQueue commandQueue;
+
+// Sample scheduling jitter, written by the sampling task
+uint32_t samplePeriodMs = 10000;
+std::atomic<uint32_t> lastJitterUs(0);
+std::atomic<uint32_t> maxJitterUs(0);
+
+// Wakes the network task out of its select() when another task has work for it
+WakeSignal networkWake;
+// Notified per queued command so the loop task can block until one arrives
+TaskHandle_t loopTaskHandle;
+
+// Modem/light sleep between jobs; configured in setup, updated by the network task
+PowerManager power;
+
+// Published on the metrics topic; instruments may be recorded from any task
+MetricsRegistry metricsRegistry;
+Histogram networkLoopUs(LOOP_US_BOUNDS, 6);
+Histogram sampleUs(LOOP_US_BOUNDS, 6);
+Gauge freeHeap;
+Gauge minFreeHeap;
+Gauge largestFreeBlock;
+Gauge telemetryDepth;
+Gauge commandDepth;
+Gauge outboxDepth;
+Gauge inflightDepth;
+
+// Periodic network task jobs; only touched by the network task
+TimerWheel networkJobs;
+int heartbeatTimer = -1;
+int statusTimer = -1;
+unsigned long maxNetworkStall = 0;  // Longest network/MQTT update since the last status
+
+void samplingTask(void* param);
+void networkTask(void* param);
+
+// Commands are decoded and dispatched on the loop task
+CommandRouter commandRouter;
+std::atomic<bool> statusRequested(false);
+std::atomic<bool> traceRequested(false);
+
+// Streams a trace dump into a publish opened with beginPublish()
+class PublishPrint : public Print {
+public:
+  size_t write(uint8_t c) override { return mqtt.write(&c, 1); }
+  size_t write(const uint8_t* data, size_t length) override { return mqtt.write(data, length); }
+};
+
+// Only touched by the sampling task
+SensorBatch sensorBatch;
+ReportFilter temperatureFilter;
+ReportFilter humidityFilter;
 
 void onConnected(NetInterface interface) {
     Serial.print("Connected via ");
@@ -34,6 +105,11 @@ void onDisconnected(NetInterface interface) {
     }
 }
 
+// WiFi, Ethernet and PPP events; state is read back in NetworkController::update()
+void onNetworkEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    networkWake.notify();
+}
+
 void showSensorInfo(){
   Serial.println(F("DHTxx Unified Sensor Example"));
   // Print temperature sensor details.
@@ -61,10 +137,290 @@ void showSensorInfo(){
   delayMS = sensor.min_delay / 1000;
 }
 
+// Called on the network task; copies the command so the MQTT buffer can be reused
+void onCommand(const char* topic, const uint8_t* payload, unsigned int length) {
+  CommandMessage* cmd = commandQueue.prepare();
+  if (!cmd) {
+    Serial.println("❌ Command queue full, dropping command");
+    return;
+  }
+  strlcpy(cmd->topic, topic, sizeof(cmd->topic));
+  cmd->length = length < sizeof(cmd->payload) ? length : sizeof(cmd->payload) - 1;
+  memcpy(cmd->payload, payload, cmd->length);
+  cmd->payload[cmd->length] = '\0';
+  cmd->receivedAt = millis();
+  commandQueue.commit();
+  xTaskNotifyGive(loopTaskHandle);
+}
+
+// {"action":"restart"}
+void onRestartCommand(JsonObjectConst command) {
+  Serial.println("Restart requested over MQTT");
+  delay(100);  // Let the log line drain
+  ESP.restart();
+}
+
+// {"action":"status"} publishes a status message on the next network task pass
+void onStatusCommand(JsonObjectConst command) {
+  statusRequested.store(true, std::memory_order_relaxed);
+  networkWake.notify();
+}
+
+// {"action":"trace"} publishes the trace buffer to <status topic>/trace;
+// {"action":"trace","serial":true} prints it here instead
+void onTraceCommand(JsonObjectConst command) {
+  if (command["serial"] | false) {
+    Trace::pause(true);
+    Trace::dump(Serial);
+    Trace::pause(false);
+    return;
+  }
+  traceRequested.store(true, std::memory_order_relaxed);
+  networkWake.notify();
+}
+
+void sampleSensors() {
+  sensors_event_t temperatureEvent;
+  sensors_event_t humidityEvent;
+  float temperature = NAN;
+  float humidity = NAN;
+
+  // Read both channels before logging so the trace separates sensor and Serial time
+  {
+    TraceScope scope(TRACE_DHT_READ);
+    dht.temperature().getEvent(&temperatureEvent);
+    dht.humidity().getEvent(&humidityEvent);
+  }
+
+  {
+    TraceScope scope(TRACE_SENSOR_LOG);
+    if (!isnan(temperatureEvent.temperature)) {
+      temperature = temperatureEvent.temperature;
+      Serial.print(F("Temperature: "));
+      Serial.print(temperature);
+      Serial.println(F("°C"));
+    } else {
+      Serial.println(F("Error reading temperature!"));
+    }
+
+    if (!isnan(humidityEvent.relative_humidity)) {
+      humidity = humidityEvent.relative_humidity;
+      Serial.print(F("Humidity: "));
+      Serial.print(humidity);
+      Serial.println(F("%"));
+    } else {
+      Serial.println(F("Error reading humidity!"));
+    }
+
+    if (isnan(temperature) || isnan(humidity)) {
+      Serial.println(F("Failed to read from DHT sensor!"));
+      return;
+    }
+  }
+
+  unsigned long now = millis();
+
+  // Both values travel in one message, so either channel changing sends both;
+  // only the channel that changed counts the reading as sent
+  bool temperatureChanged = temperatureFilter.wantsReport(temperature, now);
+  bool humidityChanged = humidityFilter.wantsReport(humidity, now);
+  if (!temperatureChanged && !humidityChanged) {
+    temperatureFilter.markSuppressed();
+    humidityFilter.markSuppressed();
+    // A partial batch still has to go out once it reaches mqtt.batch.maxAgeMs
+    if (!sensorBatch.isEnabled() || !sensorBatch.isDue(now)) return;
+  } else {
+    if (temperatureChanged) temperatureFilter.markReported(temperature, now);
+    else temperatureFilter.markCarried(temperature, now);
+    if (humidityChanged) humidityFilter.markReported(humidity, now);
+    else humidityFilter.markCarried(humidity, now);
+
+    if (sensorBatch.isEnabled()) {
+      sensorBatch.add(now, temperature, humidity);
+      if (!sensorBatch.isDue(now)) return;
+    }
+  }
+
+  // Format straight into the queue slot; the network task publishes it as-is
+  TraceScope scope(TRACE_SENSOR_FORMAT);
+  TelemetryMessage* msg = telemetryQueue.prepare();
+  if (!msg) {
+    Serial.println(F("❌ Telemetry queue full, dropping sample"));
+    sensorBatch.clear();
+    return;
+  }
+  PayloadWriter sensorData(msg->payload, sizeof(msg->payload), ConfigLoader::getMQTTSensorFormat());
+  if (sensorBatch.isEnabled()) {
+    sensorBatch.encode(sensorData);
+    sensorBatch.clear();
+  } else {
+    SensorBatch::encodeReading(sensorData, now, temperature, humidity);
+  }
+  if (!sensorData.ok()) return;
+  msg->topic = TELEMETRY_SENSOR;
+  msg->length = sensorData.size();
+  telemetryQueue.commit();
+  networkWake.notify();
+}
+
+void publishStatus() {
+  char payload[896];
+  PayloadWriter statusMsg(payload, sizeof(payload), ConfigLoader::getMQTTStatusFormat());
+  statusMsg.beginObject();
+  statusMsg.add("uptime", millis() / 1000);
+  statusMsg.add("network", netManager.getState() == CONNECTED ? "connected" : "disconnected");
+  statusMsg.add("mqtt", mqtt.isConnected() ? "connected" : "disconnected");
+  statusMsg.add("maxStallMs", maxNetworkStall / 1000);
+  statusMsg.beginObject("sampling");
+  statusMsg.add("lastJitterUs", lastJitterUs.load(std::memory_order_relaxed));
+  statusMsg.add("maxJitterUs", maxJitterUs.exchange(0, std::memory_order_relaxed));
+  statusMsg.add("droppedSamples", (unsigned long)telemetryQueue.getDropped());
+  statusMsg.endObject();
+  statusMsg.beginObject("reports");
+  statusMsg.add("temperatureSent", temperatureFilter.getReported());
+  statusMsg.add("temperatureSuppressed", temperatureFilter.getSuppressed());
+  statusMsg.add("humiditySent", humidityFilter.getReported());
+  statusMsg.add("humiditySuppressed", humidityFilter.getSuppressed());
+  statusMsg.endObject();
+  statusMsg.beginObject("commands");
+  statusMsg.add("handled", commandRouter.getHandled());
+  statusMsg.add("unknown", commandRouter.getUnknown());
+  statusMsg.add("rejected", commandRouter.getRejected());
+  statusMsg.endObject();
+  statusMsg.beginObject("outbox");
+  statusMsg.add("depth", mqtt.getOutbox().getDepth());
+  statusMsg.add("bytes", mqtt.getOutbox().getBytesStored());
+  statusMsg.add("dropped", mqtt.getOutbox().getDropped());
+  statusMsg.endObject();
+  statusMsg.beginObject("failover");
+  statusMsg.add("interface", NetworkController::interfaceName(netManager.getCurrentInterface()));
+  statusMsg.add("count", netManager.getFailoverCount());
+  statusMsg.add("lastMs", netManager.getLastFailoverMs());
+  statusMsg.add("mqttOutageMs", mqtt.getLastOutageMs());
+  statusMsg.endObject();
+  statusMsg.beginObject("scores");
+  const NetInterface interfaces[] = { ETHERNET, WIFI, LTE };
+  for (NetInterface interface : interfaces) {
+    if (netManager.isLinkEnabled(interface)) {
+      statusMsg.add(NetworkController::interfaceName(interface), (unsigned)netManager.getScore(interface));
+    }
+  }
+  statusMsg.endObject();
+  const InflightStats& delivery = mqtt.getDeliveryStats();
+  statusMsg.beginObject("qos");
+  statusMsg.add("inflight", (unsigned)mqtt.getInflightCount());
+  statusMsg.add("acked", delivery.acked);
+  statusMsg.add("resent", delivery.retransmitted);
+  statusMsg.add("lastAckMs", delivery.lastAckMs);
+  statusMsg.add("maxAckMs", delivery.maxAckMs);
+  statusMsg.endObject();
+  statusMsg.beginObject("power");
+  statusMsg.add("mode", PowerManager::modeName(power.getMode()));
+  statusMsg.add("lightSleep", power.isLightSleepActive());
+  statusMsg.add("wakeLateMs", power.getMaxWakeLateMs());
+  statusMsg.add("commandMs", power.getLastCommandMs());
+  statusMsg.add("maxCommandMs", power.takeMaxCommandMs());
+  statusMsg.endObject();
+  power.resetWakeLate();
+  const TLSHandshakeStats& tls = mqtt.getTLSStats();
+  statusMsg.beginObject("tls");
+  statusMsg.add("full", tls.full);
+  statusMsg.add("resumed", tls.resumed);
+  statusMsg.add("lastFullMs", tls.lastFullMs);
+  statusMsg.add("lastResumedMs", tls.lastResumedMs);
+  statusMsg.add("avgFullMs", tls.full ? tls.totalFullMs / tls.full : 0);
+  statusMsg.add("avgResumedMs", tls.resumed ? tls.totalResumedMs / tls.resumed : 0);
+  statusMsg.endObject();
+  statusMsg.endObject();
+  if (statusMsg.ok() && mqtt.publishStatus(statusMsg.c_str(), statusMsg.size())) {
+    Serial.println("Status update sent");
+  }
+  maxNetworkStall = 0;
+}
+
+void onStatusTimer(void* context) {
+  publishStatus();
+}
+
+void onMetricsTimer(void* context) {
+  // Gauges are sampled here; everything else was recorded as it happened
+  freeHeap.set(ESP.getFreeHeap());
+  minFreeHeap.set(ESP.getMinFreeHeap());
+  largestFreeBlock.set(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+  telemetryDepth.set(telemetryQueue.size());
+  commandDepth.set(commandQueue.size());
+  outboxDepth.set(mqtt.getOutbox().getDepth());
+  inflightDepth.set(mqtt.getInflightCount());
+
+  char payload[METRICS_PAYLOAD_SIZE];
+  PayloadWriter snapshot(payload, sizeof(payload), ConfigLoader::getMQTTMetricsFormat());
+  if (!metricsRegistry.snapshot(snapshot)) {
+    Serial.println("❌ Metrics snapshot exceeds buffer");
+    return;
+  }
+  mqtt.publishMetrics(snapshot.c_str(), snapshot.size());
+}
+
+// Streamed with its length announced up front, with recording paused so the length holds
+void publishTrace() {
+  char topic[80];
+  snprintf(topic, sizeof(topic), "%s/trace", ConfigLoader::getMQTTStatusTopic());
+  Trace::pause(true);
+  size_t length = Trace::dumpLength();
+  bool sent = false;
+  if (mqtt.beginPublish(topic, length)) {
+    PublishPrint out;
+    Trace::dump(out);
+    sent = mqtt.endPublish();  // Drops the session if the dump came up short
+  }
+  Trace::pause(false);
+  if (sent) {
+    Serial.printf("Trace sent (%u bytes)\n", (unsigned)length);
+  } else {
+    Serial.println("❌ Trace publish failed");
+  }
+}
+
+void onHeartbeatTimer(void* context) {
+  if (mqtt.publishHeartbeat()) {
+    Serial.println("Heartbeat sent");
+  }
+}
+
+// Section bounds from the ESP-IDF linker script
+extern "C" uint8_t _data_start, _data_end, _bss_start, _bss_end;
+
+// Everything long-lived is static, so after setup() the heap should only hold
+// the task stacks, driver buffers, certificates and PubSubClient's packet
+// buffer. Free heap and its low-water mark are published as metrics to show
+// it stays flat from then on.
+void printMemoryBudget(size_t heapAtBoot) {
+  Serial.println("Memory budget:");
+  Serial.printf("  Interfaces: WiFi%s%s\n", BOARD_HAS_ETHERNET ? ", Ethernet" : "", BOARD_HAS_LTE ? ", LTE" : "");
+  Serial.printf("  Static RAM: .data %u B, .bss %u B\n", (unsigned)(&_data_end - &_data_start), (unsigned)(&_bss_end - &_bss_start));
+  Serial.printf("  Modules: network %u B, mqtt %u B, config %u B, commands %u B, sensor batch %u B\n",
+                (unsigned)sizeof(NetworkController), (unsigned)sizeof(MQTTModule), (unsigned)sizeof(DeviceConfig),
+                (unsigned)sizeof(CommandRouter), (unsigned)sizeof(SensorBatch));
+  Serial.printf("  Queues: telemetry %u B, commands %u B\n", (unsigned)sizeof(TelemetryQueue), (unsigned)sizeof(CommandQueue));
+  Serial.printf("  Task stacks: network %u B, sampling %u B\n", (unsigned)NETWORK_TASK_STACK, (unsigned)SAMPLING_TASK_STACK);
+  Serial.printf("  Heap: %u B total, %u B free (setup took %u B), largest block %u B\n",
+                (unsigned)ESP.getHeapSize(), (unsigned)ESP.getFreeHeap(), (unsigned)(heapAtBoot - ESP.getFreeHeap()),
+                (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+}
+
 void setup() {
+    size_t heapAtBoot = ESP.getFreeHeap();
     Serial.begin(115200);
     delay(1000);
 
+    // First, so a crash trace from the previous boot is printed before anything overwrites it
+    Trace::begin();
+    if (Trace::hasCrashTrace()) {
+        Trace::pause(true);
+        Trace::dump(Serial);
+        Trace::pause(false);
+    }
+
     dht.begin();
     delay(2000);  // Allow sensor to stabilize after initialization
     showSensorInfo();
@@ -74,28 +430,49 @@ void setup() {
         Serial.println("Failed to load config, using defaults");
     }
 
-    netManager = new NetworkController();
-    mqtt = new MQTTModule(netManager);
-
     // Set MQTT broker from config
-    mqtt->setBroker(ConfigLoader::getMQTTBroker(), ConfigLoader::getMQTTPort());
-    mqtt->setCredentials(ConfigLoader::getMQTTClientId(), ConfigLoader::getMQTTUsername(), ConfigLoader::getMQTTPassword());
+    mqtt.setBroker(ConfigLoader::getMQTTBroker(), ConfigLoader::getMQTTPort());
+    mqtt.setCredentials(ConfigLoader::getMQTTClientId(), ConfigLoader::getMQTTUsername(), ConfigLoader::getMQTTPassword());
 
     // Set MQTT topics from config
-    mqtt->setTopics(
+    mqtt.setTopics(
         ConfigLoader::getMQTTStatusTopic(),
         ConfigLoader::getMQTTCommandTopic(),
         ConfigLoader::getMQTTSensorTopic(),
         ConfigLoader::getMQTTHeartbeatTopic()
     );
+    mqtt.setHeartbeatFormat(ConfigLoader::getMQTTHeartbeatFormat());
+    mqtt.setMetricsTopic(ConfigLoader::getMQTTMetricsTopic());
+
+    // QoS 1 keeps publishes until the broker acknowledges them
+    mqtt.setDelivery(ConfigLoader::getMQTTQoS(), ConfigLoader::getMQTTInflightWindow(), ConfigLoader::getMQTTAckTimeout());
+    mqtt.setReconnect(ConfigLoader::getMQTTReconnect().baseDelay, ConfigLoader::getMQTTReconnect().maxDelay);
+    mqtt.setKeepAlive(ConfigLoader::getMQTTKeepAlive());
+
+    // Buffer publishes on flash while the broker is unreachable
+    if (ConfigLoader::getMQTTOutboxEnabled()) {
+        mqtt.setOutbox(
+            ConfigLoader::getMQTTOutboxMaxBytes(),
+            ConfigLoader::getMQTTOutboxSegmentSize(),
+            ConfigLoader::getMQTTOutboxReplayBatch(),
+            ConfigLoader::getMQTTOutboxReplayInterval()
+        );
+    }
+
+    // Group sensor readings into one message when configured
+    sensorBatch.configure(ConfigLoader::getMQTTBatchSize(), ConfigLoader::getMQTTBatchMaxAge());
+
+    // Report-by-exception deadbands per DHT channel
+    temperatureFilter.configure(ConfigLoader::getTemperatureDeadband(), ConfigLoader::getTemperatureMinInterval(), ConfigLoader::getTemperatureMaxInterval());
+    humidityFilter.configure(ConfigLoader::getHumidityDeadband(), ConfigLoader::getHumidityMinInterval(), ConfigLoader::getHumidityMaxInterval());
 
     // Set network credentials from config
-    netManager->setWiFiCredentials(ConfigLoader::getWiFiSSID(), ConfigLoader::getWiFiPassword());
+    netManager.setWiFiCredentials(ConfigLoader::getWiFiSSID(), ConfigLoader::getWiFiPassword());
 
     // Configure WiFi static IP if enabled
     if (ConfigLoader::getWiFiStaticIPEnabled()) {
         Serial.println("WiFi static IP enabled in config");
-        netManager->setWiFiStaticIP(
+        netManager.setWiFiStaticIP(
             ConfigLoader::getWiFiStaticIP(),
             ConfigLoader::getWiFiStaticGateway(),
             ConfigLoader::getWiFiStaticSubnet(),
@@ -106,7 +483,7 @@ void setup() {
     // // Configure Ethernet static IP if enabled
     // if (ConfigLoader::getEthernetStaticIPEnabled()) {
     //     Serial.println("Ethernet static IP enabled in config");
-    //     netManager->setEthernetStaticIP(
+    //     netManager.setEthernetStaticIP(
     //         ConfigLoader::getEthernetStaticIP(),
     //         ConfigLoader::getEthernetStaticGateway(),
     //         ConfigLoader::getEthernetStaticSubnet(),
@@ -118,86 +495,177 @@ void setup() {
     //     Serial.println("Ethernet using DHCP");
     //     byte mac[6];
     //     ConfigLoader::getEthernetMAC(mac);
-    //     netManager->setEthernetConfig(mac, ConfigLoader::getEthernetIP(), ConfigLoader::getEthernetGateway(), ConfigLoader::getEthernetSubnet());
+    //     netManager.setEthernetConfig(mac, ConfigLoader::getEthernetIP(), ConfigLoader::getEthernetGateway(), ConfigLoader::getEthernetSubnet());
     // }
-    // netManager->setLTEAPN(ConfigLoader::getLTEAPN(), ConfigLoader::getLTEUser(), ConfigLoader::getLTEPass());
+#if BOARD_HAS_LTE
+    netManager.setLTEAPN(ConfigLoader::getLTEAPN(), ConfigLoader::getLTEUser(), ConfigLoader::getLTEPass());
+#endif
+
+    // All listed interfaces are kept up; standbys take over without a cold start
+    NetInterface priority[3];
+    size_t interfaceCount = ConfigLoader::getNetworkInterfaceCount();
+    for (size_t i = 0; i < interfaceCount; i++) {
+        priority[i] = ConfigLoader::getNetworkInterface(i);
+    }
+    netManager.setPriority(priority, interfaceCount);
+    netManager.setProbeTiming(ConfigLoader::getNetworkProbeInterval(), ConfigLoader::getNetworkProbeTimeout());
+    netManager.setSelection(ConfigLoader::getNetworkWeights(), ConfigLoader::getNetworkHysteresis(), ConfigLoader::getNetworkHoldTime());
+    netManager.setReconnect(ConfigLoader::getNetworkReconnect().baseDelay, ConfigLoader::getNetworkReconnect().maxDelay);
+
+    netManager.setOnConnectedCallback(onConnected);
+    netManager.setOnDisconnectedCallback(onDisconnected);
+
+    // Link changes wake the network task instead of waiting for its next poll
+    if (!networkWake.begin()) {
+        Serial.println("Network task falls back to polling");
+    }
+    WiFi.onEvent(onNetworkEvent);
 
-    netManager->setOnConnectedCallback(onConnected);
-    netManager->setOnDisconnectedCallback(onDisconnected);
+    netManager.begin();
 
-    netManager->begin();
+    // After WiFi has started, since modem sleep is a WiFi driver setting
+    power.configure(ConfigLoader::getPowerMode(), ConfigLoader::getPowerMinCpuMhz(), ConfigLoader::getPowerMaxCpuMhz());
+    power.begin();
 
     // Load certificates after network initialization
     delay(100);  // Small delay to ensure network is ready
-    mqtt->loadCertsFromSPIFFS();
+    mqtt.loadCertsFromSPIFFS();
 
     // Note: Subscription to command topic happens automatically when MQTT connects
+
+    // Networking and TLS on the protocol core, sampling on the application core
+    commandRouter.on("restart", onRestartCommand);
+    commandRouter.on("status", onStatusCommand);
+    commandRouter.on("trace", onTraceCommand);
+    mqtt.setCommandCallback(onCommand);
+
+    // Per-device, group and broadcast command filters; all are sent in one SUBSCRIBE on connect
+    for (size_t i = 0; i < ConfigLoader::getMQTTSubscriptionCount(); i++) {
+        mqtt.subscribe(ConfigLoader::getMQTTSubscription(i), onCommand);
+    }
+    // After setPriority, so reconnect times are only kept for enabled interfaces
+    mqtt.registerMetrics(metricsRegistry);
+    metricsRegistry.add("networkLoopUs", networkLoopUs);
+    metricsRegistry.add("sampleUs", sampleUs);
+    metricsRegistry.add("freeHeap", freeHeap);
+    metricsRegistry.add("minFreeHeap", minFreeHeap);
+    metricsRegistry.add("largestFreeBlock", largestFreeBlock);
+    metricsRegistry.add("telemetryQueue", telemetryDepth);
+    metricsRegistry.add("commandQueue", commandDepth);
+    metricsRegistry.add("outbox", outboxDepth);
+    metricsRegistry.add("inflight", inflightDepth);
+
+    loopTaskHandle = xTaskGetCurrentTaskHandle();  // setup() runs on the loop task
+    samplePeriodMs = ConfigLoader::getSamplePeriod();
+    xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK, nullptr, 1, nullptr, 0);
+    xTaskCreatePinnedToCore(samplingTask, "sampling", SAMPLING_TASK_STACK, nullptr, 2, nullptr, 1);
+    printMemoryBudget(heapAtBoot);
 }
 
-void loop() {
-  static unsigned long lastHeartbeat = 0;
-  static unsigned long lastSensorReading = 0;
-  static unsigned long lastStatusUpdate = 0;
+// Samples sensors on the application core at a fixed period
+void samplingTask(void* param) {
+  const TickType_t period = pdMS_TO_TICKS(samplePeriodMs);
+  TickType_t lastWake = xTaskGetTickCount();
+  int64_t firstSample = esp_timer_get_time();
+  uint32_t samples = 0;
 
-  netManager->update();
-  mqtt->update();
+  for (;;) {
+    vTaskDelayUntil(&lastWake, period);
+    samples++;
 
-  if (millis() - lastHeartbeat >= 30000) {
-    if (mqtt->publishHeartbeat()) {
-      Serial.println("Heartbeat sent");
+    // Deviation from the ideal schedule, measured before any work is done
+    int64_t expected = firstSample + (int64_t)samples * samplePeriodMs * 1000;
+    int64_t deviation = esp_timer_get_time() - expected;
+    uint32_t jitter = (uint32_t)(deviation < 0 ? -deviation : deviation);
+    lastJitterUs.store(jitter, std::memory_order_relaxed);
+    if (jitter > maxJitterUs.load(std::memory_order_relaxed)) {
+      maxJitterUs.store(jitter, std::memory_order_relaxed);
     }
-    lastHeartbeat = millis();
+
+    int64_t sampleStart = esp_timer_get_time();
+    sampleSensors();
+    sampleUs.record((uint32_t)(esp_timer_get_time() - sampleStart));
   }
+}
 
-  if (millis() - lastSensorReading >= 10000) {
-    sensors_event_t event;
-    float temperature = NAN;
-    float humidity = NAN;
+// Owns NetworkController and MQTTModule; nothing else touches them once started.
+// Sleeps until the MQTT socket is readable, another task calls
+// networkWake.notify(), a job is due or a module needs its next update().
+void networkTask(void* param) {
+  networkJobs.begin(millis());
+  heartbeatTimer = networkJobs.add(ConfigLoader::getHeartbeatInterval(), onHeartbeatTimer);
+  statusTimer = networkJobs.add(ConfigLoader::getStatusInterval(), onStatusTimer);
+  int metricsTimer = networkJobs.add(ConfigLoader::getMetricsInterval(), onMetricsTimer);
+  if (heartbeatTimer < 0 || statusTimer < 0 || metricsTimer < 0) {
+    Serial.printf("❌ Heartbeat, status and metrics intervals must be %lu-%lu ms\n", (unsigned long)TimerWheel::TICK_MS, (unsigned long)TimerWheel::MAX_PERIOD);
+  }
 
-    dht.temperature().getEvent(&event);
-    if (!isnan(event.temperature)) {
-      temperature = event.temperature;
-      Serial.print(F("Temperature: "));
-      Serial.print(temperature);
-      Serial.println(F("°C"));
-    } else {
-      Serial.println(F("Error reading temperature!"));
+  for (;;) {
+    unsigned long networkStart = micros();
+    {
+      TraceScope scope(TRACE_NETWORK_UPDATE);
+      netManager.update();
+    }
+    {
+      TraceScope scope(TRACE_MQTT_UPDATE);
+      mqtt.update();
     }
+    power.update(netManager.getCurrentInterface());
+    unsigned long networkTime = micros() - networkStart;
+    if (networkTime > maxNetworkStall) maxNetworkStall = networkTime;
+    networkLoopUs.record(networkTime);
 
-    dht.humidity().getEvent(&event);
-    if (!isnan(event.relative_humidity)) {
-      humidity = event.relative_humidity;
-      Serial.print(F("Humidity: "));
-      Serial.print(humidity);
-      Serial.println(F("%"));
-    } else {
-      Serial.println(F("Error reading humidity!"));
+    // Forward preformatted messages from the sampling task
+    while (TelemetryMessage* msg = telemetryQueue.front()) {
+      TraceScope scope(TRACE_TELEMETRY_PUBLISH);
+      if (msg->topic == TELEMETRY_SENSOR && mqtt.publishSensor(msg->payload, msg->length)) {
+        Serial.println("Sensor data sent");
+      }
+      telemetryQueue.release();
     }
 
-    if (isnan(temperature) || isnan(humidity)) {
-      Serial.println(F("Failed to read from DHT sensor!"));
-      delay(delayMS);
-      return;
+    if (traceRequested.exchange(false, std::memory_order_relaxed)) {
+      publishTrace();
     }
 
-    String sensorData = "{\"temperature\":" + String(temperature) +
-               ",\"humidity\":" + String(humidity) +
-               ",\"timestamp\":" + String(millis()) + "}";
-    if (mqtt->publishSensor(sensorData)) {
-      Serial.println("Sensor data sent");
+    if (statusRequested.exchange(false, std::memory_order_relaxed)) {
+      publishStatus();
+      networkJobs.restart(statusTimer);
+    }
+    {
+      TraceScope scope(TRACE_JOBS);
+      networkJobs.advance(millis());
     }
-    lastSensorReading = millis();
-  }
 
-  if (millis() - lastStatusUpdate >= 60000) {
-    String statusMsg = "{\"uptime\":" + String(millis()/1000) +
-              ",\"network\":\"" + (netManager->getState() == CONNECTED ? "connected" : "disconnected") + "\"" +
-              ",\"mqtt\":\"" + (mqtt->isConnected() ? "connected" : "disconnected") + "\"}";
-    if (mqtt->publishStatus(statusMsg)) {
-      Serial.println("Status update sent");
+    // PubSubClient reads one packet per loop(); the rest may already sit decrypted in TLS
+    if (mqtt.hasPendingInput()) continue;
+
+    unsigned long now = millis();
+    unsigned long wait = ConfigLoader::getMaxIdle();
+    wait = min(wait, (unsigned long)networkJobs.msUntilNext(now));
+    wait = min(wait, mqtt.getPollDelay(now));
+    wait = min(wait, netManager.getPollDelay(now));
+    if (wait == 0) wait = 1;  // Never spin; IDLE0 feeds the watchdog
+    Trace::record(TRACE_NETWORK_WAIT, TRACE_PHASE_BEGIN);
+    bool woken = networkWake.wait(mqtt.getSocket(), wait);
+    Trace::record(TRACE_NETWORK_WAIT, TRACE_PHASE_END);
+    if (!woken) {
+      power.recordWait(wait, millis() - now);
     }
-    lastStatusUpdate = millis();
   }
+}
 
-  delay(100);
-}
\ No newline at end of file
+// Command handling runs in the Arduino loop task, off the network core
+void loop() {
+  // onCommand() notifies per message; the timeout only bounds a missed notification
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+  while (CommandMessage* cmd = commandQueue.front()) {
+    // Decoded straight from the queue slot, which is released afterwards
+    unsigned long queued = millis() - cmd->receivedAt;
+    power.recordCommand(queued);
+    Serial.printf("Command from %s (queued %lu ms)\n", cmd->topic, queued);
+    TraceScope scope(TRACE_COMMAND);
+    commandRouter.dispatch(cmd->payload, cmd->length, ConfigLoader::getMQTTCommandFormat());
+    commandQueue.release();
+  }
+}
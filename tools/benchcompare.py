@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Compare two benchmark runs and fail on a regression.
+
+Save the output of env:bench (Serial) or env:bench_native before and after a
+change, then:
+
+    python3 tools/benchcompare.py before.txt after.txt [--threshold 10]
+
+Lines that are not CSV result rows are ignored, so raw Serial captures work.
+The exit status is 1 if any case got slower by more than the threshold
+percentage, or now allocates more or uses more stack than before.
+"""
+
+import argparse
+import sys
+
+FIELDS = ("iterations", "ns_per_op", "allocs_per_op", "bytes_per_op", "peak_stack_bytes")
+
+
+def parse(path):
+    results = {}
+    with open(path, encoding="utf-8", errors="replace") as handle:
+        for line in handle:
+            line = line.strip()
+            if not line or line.startswith("#") or line.startswith("name,"):
+                continue
+            parts = line.split(",")
+            if len(parts) != len(FIELDS) + 1:
+                continue
+            try:
+                values = [float(value) for value in parts[1:]]
+            except ValueError:
+                continue
+            results[parts[0]] = dict(zip(FIELDS, values))
+    return results
+
+
+def percent(before, after):
+    if before == 0:
+        return 0.0 if after == 0 else float("inf")
+    return (after - before) * 100.0 / before
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed ns/op slowdown in percent (default 10)")
+    args = parser.parse_args()
+
+    before = parse(args.before)
+    after = parse(args.after)
+    if not before or not after:
+        print("No benchmark rows found", file=sys.stderr)
+        return 1
+
+    regressions = 0
+    print(f"{'name':<28}{'ns/op':>12}{'change':>9}{'allocs':>14}{'stack':>14}")
+    for name in sorted(set(before) | set(after)):
+        if name not in before or name not in after:
+            print(f"{name:<28}{'only in ' + ('after' if name in after else 'before'):>12}")
+            continue
+        old, new = before[name], after[name]
+        change = percent(old["ns_per_op"], new["ns_per_op"])
+        problems = []
+        if change > args.threshold:
+            problems.append("slower")
+        if new["allocs_per_op"] > old["allocs_per_op"]:
+            problems.append("allocates")
+        if new["peak_stack_bytes"] > old["peak_stack_bytes"]:
+            problems.append("stack")
+        allocs = f"{old['allocs_per_op']:g}->{new['allocs_per_op']:g}"
+        stack = f"{old['peak_stack_bytes']:g}->{new['peak_stack_bytes']:g}"
+        print(f"{name:<28}{new['ns_per_op']:>12.1f}{change:>+8.1f}%{allocs:>14}{stack:>14}"
+              + (f"  REGRESSION ({', '.join(problems)})" if problems else ""))
+        if problems:
+            regressions += 1
+
+    if regressions:
+        print(f"{regressions} case(s) regressed")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,109 @@
+// Fleet reconnect simulation for Backoff. Every device loses the broker at
+// t=0, the broker comes back after the outage and accepts a limited number of
+// connections per second. Prints connection attempts per second for the old
+// fixed 5 s retry and for jittered exponential backoff.
+//
+//   g++ -std=c++11 -O2 -Iinclude tools/reconnect_sim.cpp src/Backoff.cpp -o reconnect_sim
+//   ./reconnect_sim [devices] [outageMs] [acceptsPerSecond] [baseMs] [maxMs]
+
+#include "Backoff.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+struct Device {
+    bool connected;
+    uint32_t nextAttempt;  // Fixed mode only
+    Backoff retry;
+};
+
+struct Result {
+    std::vector<uint32_t> attempts;  // Per second
+    uint32_t peak;
+    uint32_t allConnectedMs;
+};
+
+static const uint32_t FIXED_DELAY = 5000;
+static const uint32_t STEP = 10;          // ms, roughly one network task iteration
+static const uint32_t HORIZON = 900000;
+
+static Result simulate(bool jitter, uint32_t devices, uint32_t outage, uint32_t acceptsPerSecond,
+                       uint32_t baseDelay, uint32_t maxDelay) {
+    std::vector<Device> fleet(devices);
+    for (uint32_t i = 0; i < devices; i++) {
+        fleet[i].connected = false;
+        fleet[i].nextAttempt = 0;
+        fleet[i].retry.configure(baseDelay, maxDelay, (i + 1) * 2654435761u);
+        if (jitter) fleet[i].retry.schedule(0);  // Session lost
+    }
+
+    Result result;
+    result.attempts.assign(HORIZON / 1000, 0);
+    result.peak = 0;
+    result.allConnectedMs = 0;
+
+    uint32_t connectedCount = 0;
+    uint32_t acceptedThisSecond = 0;
+    for (uint32_t now = 0; now < HORIZON && connectedCount < devices; now += STEP) {
+        if (now % 1000 == 0) acceptedThisSecond = 0;
+        for (Device& device : fleet) {
+            if (device.connected) continue;
+            bool due = jitter ? device.retry.isDue(now) : now >= device.nextAttempt;
+            if (!due) continue;
+
+            result.attempts[now / 1000]++;
+            if (now >= outage && acceptedThisSecond < acceptsPerSecond) {
+                acceptedThisSecond++;
+                device.connected = true;
+                device.retry.reset();
+                connectedCount++;
+            } else if (jitter) {
+                device.retry.schedule(now);
+            } else {
+                device.nextAttempt = now + FIXED_DELAY;
+            }
+        }
+        if (connectedCount == devices) result.allConnectedMs = now;
+    }
+    for (uint32_t count : result.attempts) {
+        if (count > result.peak) result.peak = count;
+    }
+    return result;
+}
+
+static void report(const char* name, const Result& result) {
+    uint32_t total = 0;
+    for (uint32_t count : result.attempts) total += count;
+    printf("# %s: %lu attempts, peak %lu/s, ", name, (unsigned long)total, (unsigned long)result.peak);
+    if (result.allConnectedMs) {
+        printf("all connected at %lu ms\n", (unsigned long)result.allConnectedMs);
+    } else {
+        printf("not all connected within %lu ms\n", (unsigned long)HORIZON);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t devices = argc > 1 ? strtoul(argv[1], nullptr, 10) : 5000;
+    uint32_t outage = argc > 2 ? strtoul(argv[2], nullptr, 10) : 60000;
+    uint32_t acceptsPerSecond = argc > 3 ? strtoul(argv[3], nullptr, 10) : 200;
+    uint32_t baseDelay = argc > 4 ? strtoul(argv[4], nullptr, 10) : 2000;
+    uint32_t maxDelay = argc > 5 ? strtoul(argv[5], nullptr, 10) : 120000;
+
+    printf("# %lu devices, %lu ms outage, broker accepts %lu/s, backoff %lu-%lu ms\n",
+           (unsigned long)devices, (unsigned long)outage, (unsigned long)acceptsPerSecond,
+           (unsigned long)baseDelay, (unsigned long)maxDelay);
+    Result fixed = simulate(false, devices, outage, acceptsPerSecond, baseDelay, maxDelay);
+    Result backoff = simulate(true, devices, outage, acceptsPerSecond, baseDelay, maxDelay);
+    report("fixed", fixed);
+    report("backoff", backoff);
+
+    // CSV for plotting; stops once both fleets are back
+    uint32_t last = fixed.allConnectedMs > backoff.allConnectedMs ? fixed.allConnectedMs : backoff.allConnectedMs;
+    if (!fixed.allConnectedMs || !backoff.allConnectedMs) last = HORIZON - 1;
+    printf("second,fixed,backoff\n");
+    for (uint32_t second = 0; second <= last / 1000; second++) {
+        printf("%lu,%lu,%lu\n", (unsigned long)second, (unsigned long)fixed.attempts[second],
+               (unsigned long)backoff.attempts[second]);
+    }
+    return 0;
+}
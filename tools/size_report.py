@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Record and compare flash and RAM use per board profile.
+
+As a PlatformIO post script (extra_scripts in platformio.ini) it reads the
+section sizes of each firmware.elf after linking, prints them and updates
+that environment's row in .pio/build/size_report.csv. Build the profiles,
+then print the table:
+
+    pio run -e esp32dev -e esp32dev_wifi -e esp32dev_lte
+    python3 tools/size_report.py [.pio/build/size_report.csv]
+"""
+
+import csv
+import os
+import re
+import subprocess
+import sys
+
+FIELDS = ("env", "flash_bytes", "ram_bytes", "ethernet", "lte")
+
+# Fallbacks match the espressif32 platform's own size check
+PROG_REGEXP = r"^(?:\.iram0\.text|\.iram0\.vectors|\.dram0\.data|\.flash\.text|\.flash\.rodata|)\s+([0-9]+).*"
+DATA_REGEXP = r"^(?:\.dram0\.data|\.dram0\.bss|\.noinit)\s+([0-9]+).*"
+
+
+def read_report(path):
+    rows = {}
+    if os.path.isfile(path):
+        with open(path, newline="", encoding="utf-8") as handle:
+            for row in csv.DictReader(handle):
+                rows[row["env"]] = row
+    return rows
+
+
+def write_report(path, rows):
+    with open(path, "w", newline="", encoding="utf-8") as handle:
+        writer = csv.DictWriter(handle, fieldnames=FIELDS)
+        writer.writeheader()
+        for name in sorted(rows):
+            writer.writerow(rows[name])
+
+
+def section_total(output, pattern):
+    regexp = re.compile(pattern)
+    total = 0
+    for line in output.splitlines():
+        match = regexp.search(line)
+        if match:
+            total += int(match.group(1))
+    return total
+
+
+def board_flag(env, name, default):
+    for define in env.get("CPPDEFINES", []):
+        if isinstance(define, (tuple, list)) and define[0] == name:
+            return str(define[1])
+    return default
+
+
+def record_size(env, elf):
+    output = subprocess.run([env.subst("$SIZETOOL"), "-A", "-d", elf],
+                            capture_output=True, text=True, check=True).stdout
+    flash = section_total(output, env.get("SIZEPROGREGEXP", PROG_REGEXP))
+    ram = section_total(output, env.get("SIZEDATAREGEXP", DATA_REGEXP))
+    name = env.subst("$PIOENV")
+    # Defaults as in board.h
+    ethernet = board_flag(env, "BOARD_HAS_ETHERNET", "1")
+    lte = board_flag(env, "BOARD_HAS_LTE", "0")
+    print(f"Board profile {name} (Ethernet {ethernet}, LTE {lte}): flash {flash} B, RAM {ram} B")
+
+    path = os.path.join(env.subst("$PROJECT_BUILD_DIR"), "size_report.csv")
+    rows = read_report(path)
+    rows[name] = {"env": name, "flash_bytes": flash, "ram_bytes": ram, "ethernet": ethernet, "lte": lte}
+    write_report(path, rows)
+
+
+def print_table(path):
+    rows = read_report(path)
+    if not rows:
+        print(f"No sizes in {path}; build the board profiles first", file=sys.stderr)
+        return 1
+    # Differences are against the smallest build
+    base = min(rows.values(), key=lambda row: int(row["flash_bytes"]))
+    print(f"{'env':<20}{'eth':>4}{'lte':>4}{'flash':>10}{'delta':>9}{'RAM':>9}{'delta':>8}")
+    for name in sorted(rows, key=lambda name: int(rows[name]["flash_bytes"])):
+        row = rows[name]
+        flash, ram = int(row["flash_bytes"]), int(row["ram_bytes"])
+        print(f"{name:<20}{row['ethernet']:>4}{row['lte']:>4}{flash:>10}{flash - int(base['flash_bytes']):>+9}"
+              f"{ram:>9}{ram - int(base['ram_bytes']):>+8}")
+    return 0
+
+
+try:
+    Import("env")  # noqa: F821 - provided by SCons when run by PlatformIO
+except NameError:
+    if __name__ == "__main__":
+        sys.exit(print_table(sys.argv[1] if len(sys.argv) > 1 else ".pio/build/size_report.csv"))
+else:
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf",  # noqa: F821
+                      lambda target, source, env: record_size(env, str(target[0])))
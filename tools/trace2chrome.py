@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Convert a device trace dump into Chrome trace JSON.
+
+Capture the dump from Serial ({"action":"trace","serial":true}) or from the
+<status topic>/trace MQTT message, then:
+
+    python3 tools/trace2chrome.py trace.txt > trace.json
+
+Open trace.json in chrome://tracing or https://ui.perfetto.dev. Each boot in
+the buffer is a process, numbered as the device counts boots, and each core
+a thread.
+"""
+
+import json
+import sys
+
+CYCLE_WRAP = 1 << 32
+
+
+def parse(lines):
+    cpu_mhz = 240
+    boot_count = 1
+    names = {}
+    rows = []
+    for line in lines:
+        line = line.strip()
+        if not line:
+            continue
+        if line.startswith("# trace"):
+            for field in line[2:].split()[1:]:
+                key, _, value = field.partition("=")
+                if key == "cpuMHz":
+                    cpu_mhz = int(value)
+                elif key == "boot":
+                    boot_count = int(value)
+        elif line.startswith("# name"):
+            _, _, ident, name = line.split(None, 3)
+            names[int(ident)] = name
+        elif line[0].isdigit():
+            core, cycles, ident, phase = line.split(",")
+            rows.append((int(core), int(cycles), int(ident), phase))
+    return cpu_mhz, boot_count, names, rows
+
+
+def convert(cpu_mhz, boot_count, names, rows):
+    boot_id = next((i for i, n in names.items() if n == "boot"), 0)
+    events = []
+    by_core = {}
+    for row in rows:
+        by_core.setdefault(row[0], []).append(row)
+
+    for core, records in by_core.items():
+        # Records are oldest first; cycles restart at each boot and wrap at 32 bits.
+        # Rings fill at different rates, so boots are numbered back from the newest.
+        boot = boot_count - sum(1 for r in records if r[2] == boot_id)
+        base = 0
+        last = None
+        stack = []
+        for _, cycles, ident, phase in records:
+            if ident == boot_id:
+                boot += 1
+                base = 0
+                last = None
+                stack = []
+            elif last is not None and cycles < last:
+                base += CYCLE_WRAP
+            last = cycles
+            ts = (base + cycles) / cpu_mhz
+            name = names.get(ident, str(ident))
+            if phase == "B":
+                stack.append(ident)
+            elif phase == "E":
+                # The ring may have overwritten the matching begin
+                if not stack or stack[-1] != ident:
+                    continue
+                stack.pop()
+            event = {"name": name, "ph": phase, "ts": ts, "pid": boot, "tid": core}
+            if phase == "i":
+                event["s"] = "t"
+            events.append(event)
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    source = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    with source:
+        cpu_mhz, boot_count, names, rows = parse(source)
+    json.dump(convert(cpu_mhz, boot_count, names, rows), sys.stdout)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()